@@ -0,0 +1,460 @@
+#include "BatchAnalysis.h"
+#include "EmbeddedModels.h"
+#include "SampleSanitizer.h"
+#include <algorithm>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+
+namespace BatchAnalysis
+{
+    namespace
+    {
+        constexpr double holdSeconds = 0.2;    // the plugin's enhancement hold, which the detector sits out
+
+        double secondsSince(juce::int64 startTicks)
+        {
+            return juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+        }
+
+        Event makeEvent(juce::int64 detection, int onsetAge, float confidence, double sampleRate)
+        {
+            return { double(detection) / sampleRate, double(detection - onsetAge) / sampleRate, confidence };
+        }
+
+        juce::String quoteCsv(const juce::String& field)
+        {
+            if (!field.containsAnyOf(",\"\n"))
+                return field;
+            return "\"" + field.replace("\"", "\"\"") + "\"";
+        }
+    }
+
+    double FileResult::getRealTimeFactor() const
+    {
+        const double duration = getDurationSeconds();
+        return duration > 0.0 ? (decodeSeconds + analysisSeconds) / duration : 0.0;
+    }
+
+    double FileResult::getIngestRate() const
+    {
+        return decodeSeconds > 0.0 ? double(numBytes) / decodeSeconds * 1.0e-9 : 0.0;
+    }
+
+    Analyzer::Analyzer(const Config& newConfig)
+        : config(newConfig)
+    {
+        config.blockSize = juce::jmax(64, config.blockSize);
+        formats.registerBasicFormats();
+
+        // The models the plugin would have: compiled-in, on-disk overrides, then the given exports
+        registry.setQuantizedForests(config.quantizedForest);
+        EmbeddedModels::load(registry);
+        registry.loadDirectory(EmbeddedModels::getOverrideDirectory());
+        if (config.modelDirectory.isDirectory())
+            registry.loadDirectory(config.modelDirectory);
+
+        classifier.loadModel("");
+        classifier.setModel(getModel());
+
+        // Preallocated for stereo; files with more channels grow the block once
+        block.setSize(2, config.blockSize);
+        analysis.resize(static_cast<size_t>(config.blockSize));
+    }
+
+    Analyzer::~Analyzer() = default;
+
+    const FootstepModel* Analyzer::getModel() const
+    {
+        // As the plugin, offline render included: unavailable tiers fall back to the built-in weights
+        const int tier = juce::jlimit(0, FootstepModel::NUM_TIERS, config.tier);
+        return tier > 0 ? registry.getModel(static_cast<FootstepModel::Tier>(tier - 1)).get() : nullptr;
+    }
+
+    juce::int64 Analyzer::getOverlap(double sampleRate)
+    {
+        return MLFootstepClassifier::WINDOW_SIZE + OfflineDetector::getCooldownSamples(sampleRate)
+             + static_cast<juce::int64>(sampleRate * holdSeconds);
+    }
+
+    FileResult Analyzer::analyse(const juce::File& file)
+    {
+        return analyseRange(file, 0, -1, nullptr);
+    }
+
+    FileResult Analyzer::analyse(const juce::File& file, juce::int64 start, juce::int64 end, Seam& seam)
+    {
+        jassert(config.highAccuracy);
+        return analyseRange(file, start, end, &seam);
+    }
+
+    FileResult Analyzer::analyseRange(const juce::File& file, juce::int64 start, juce::int64 end, Seam* seam)
+    {
+        FileResult result;
+        result.file = file;
+
+        const auto openTicks = juce::Time::getHighResolutionTicks();
+        std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(file));
+        if (reader == nullptr) {
+            result.error = "unsupported or unreadable audio file";
+            return result;
+        }
+
+        result.format = reader->getFormatName();
+        result.sampleRate = reader->sampleRate;
+        result.numChannels = static_cast<int>(reader->numChannels);
+        result.numSamples = reader->lengthInSamples;
+        result.decodeSeconds = secondsSince(openTicks);
+
+        const auto* model = classifier.getModel();
+        result.model = model != nullptr ? model->getName() : juce::String("Built-in weights");
+
+        if (result.sampleRate <= 0.0 || result.numChannels <= 0) {
+            result.error = "no audio";
+            return result;
+        }
+
+        // The detector as prepareToPlay sets it up; a file is one continuous stream
+        MLFootstepClassifier::Schedule schedule;
+        schedule.holdOffSamples = static_cast<int>(result.sampleRate * holdSeconds);
+        classifier.prepare(result.sampleRate, config.blockSize);
+        classifier.setSchedule(schedule);
+        if (config.highAccuracy)
+            offlineDetector.prepare(result.sampleRate, config.blockSize, nullptr, 0);
+
+        speakerGroups.prepare(reader->getChannelLayout());
+        const auto& channels = speakerGroups.getChannels(SpeakerGroups::allSpeakers, 0);
+
+        if (end < 0 || end > result.numSamples)
+            end = result.numSamples;
+
+        // Chunks warm up from the hop grid point an overlap or more before their start,
+        // so their decisions fall on the same samples as in one pass over the file
+        juce::int64 first = start;
+        if (seam != nullptr) {
+            first = std::max<juce::int64>(0, start - getOverlap(result.sampleRate)) / OfflineDetector::hop * OfflineDetector::hop;
+            seam->cooldownAtStart = first;
+            seam->candidates.clear();
+        }
+
+        // WAV and AIFF are mixed straight from the mapped file; the rest is decoded in blocks
+        const auto mapTicks = juce::Time::getHighResolutionTicks();
+        result.memoryMapped = mappedAudio.open(file, formats) && mappedAudio.map(first, end);
+        if (!result.memoryMapped)
+            block.setSize(result.numChannels, config.blockSize, false, false, true);
+        result.decodeSeconds += secondsSince(mapTicks);
+
+        const int bytesPerFrame = result.numChannels * static_cast<int>(reader->bitsPerSample / 8);
+
+        for (juce::int64 position = first; position < end;)
+        {
+            // Warm-up blocks stop at the chunk start, where the settled cooldown is read
+            const juce::int64 blockEnd = position < start ? start : end;
+            const int numSamples = static_cast<int>(std::min<juce::int64>(config.blockSize, blockEnd - position));
+
+            // Analysis downmix as renderAnalysisSignals builds it
+            const auto decodeTicks = juce::Time::getHighResolutionTicks();
+            if (result.memoryMapped)
+                mappedAudio.downmix(position, numSamples, channels, analysis.data());
+            else
+                readDownmix(*reader, position, numSamples, channels);
+
+            const auto analysisTicks = juce::Time::getHighResolutionTicks();
+            result.decodeSeconds += juce::Time::highResolutionTicksToSeconds(analysisTicks - decodeTicks);
+            result.numBytes += juce::int64(numSamples) * bytesPerFrame;
+
+            detect(analysis.data(), numSamples, position, start, result.sampleRate, result, seam);
+            result.analysisSeconds += secondsSince(analysisTicks);
+
+            position += numSamples;
+            if (seam != nullptr && position == start)
+                seam->cooldownAtStart = first + offlineDetector.getCooldownEnd();
+        }
+
+        if (seam != nullptr)
+            seam->cooldownAtEnd = first + offlineDetector.getCooldownEnd();
+
+        mappedAudio.close();
+        return result;
+    }
+
+    void Analyzer::readDownmix(juce::AudioFormatReader& reader, juce::int64 position, int numSamples, const std::vector<int>& channels)
+    {
+        const int numChannels = block.getNumChannels();
+        reader.read(&block, 0, numSamples, position, true, true);
+
+        int numMixed = 0;
+        for (int channel : channels) {
+            if (channel >= numChannels)
+                continue;
+
+            float* channelData = block.getWritePointer(channel);
+            SampleSanitizer::replaceNonFinite(channelData, numSamples);
+
+            if (numMixed++ == 0)
+                juce::FloatVectorOperations::copy(analysis.data(), channelData, numSamples);
+            else
+                juce::FloatVectorOperations::add(analysis.data(), channelData, numSamples);
+        }
+
+        if (numMixed == 0)
+            juce::FloatVectorOperations::clear(analysis.data(), numSamples);
+        else if (numMixed > 1)
+            juce::FloatVectorOperations::multiply(analysis.data(), 1.0f / float(numMixed), numSamples);
+    }
+
+    void Analyzer::detect(const float* samples, int numSamples, juce::int64 position, juce::int64 start, double sampleRate,
+                          FileResult& result, Seam* seam)
+    {
+        // Detections before the start are in the overlap, which the previous chunk reports
+        auto addEvent = [&](int offset, int onsetAge, float confidence) {
+            const juce::int64 detection = position + offset;
+            if (detection >= start)
+                result.events.push_back(makeEvent(detection, onsetAge, confidence, sampleRate));
+        };
+
+        if (config.highAccuracy) {
+            for (const auto& event : offlineDetector.process(classifier, samples, numSamples, config.sensitivity))
+                addEvent(event.offset, event.onsetAge, event.confidence);
+
+            if (seam != nullptr)
+                for (const auto& candidate : offlineDetector.getCandidates())
+                    if (position + candidate.offset >= start)
+                        seam->candidates.push_back({ position + candidate.offset, candidate.onsetAge, candidate.confidence });
+            return;
+        }
+
+        for (int sample = 0; sample < numSamples; ++sample)
+            if (classifier.detectFootstep(samples[sample], config.sensitivity))
+                addEvent(sample, classifier.getLastOnsetAge(), classifier.getLastConfidence());
+    }
+
+    Batch::Batch(const Config& newConfig, int numThreads)
+        : config(newConfig), pool(numThreads)
+    {
+        for (int worker = 0; worker < pool.getNumWorkers(); ++worker)
+            analyzers.push_back(std::make_unique<Analyzer>(config));
+    }
+
+    Batch::~Batch() = default;
+
+    std::vector<Batch::Task> Batch::split(const juce::Array<juce::File>& files)
+    {
+        std::vector<Task> tasks;
+        tasks.reserve(static_cast<size_t>(files.size()));
+
+        for (int index = 0; index < files.size(); ++index) {
+            const double bytes = double(files[index].getSize());
+
+            juce::int64 length = 0, chunkLength = 0;
+            if (config.highAccuracy && config.chunkSeconds > 0.0) {
+                if (std::unique_ptr<juce::AudioFormatReader> reader { getFormats().createReaderFor(files[index]) }) {
+                    length = reader->lengthInSamples;
+                    chunkLength = static_cast<juce::int64>(config.chunkSeconds * reader->sampleRate);
+                }
+            }
+
+            // Short files, the streaming detector and unreadable files (analyse reports them) go whole
+            if (chunkLength <= 0 || length <= chunkLength) {
+                Task task;
+                task.file = index;
+                task.size = bytes;
+                tasks.push_back(std::move(task));
+                continue;
+            }
+
+            for (juce::int64 start = 0; start < length; start += chunkLength) {
+                Task task;
+                task.file = index;
+                task.start = start;
+                task.end = std::min(length, start + chunkLength);
+                task.size = bytes * double(task.end - task.start) / double(length);
+                tasks.push_back(std::move(task));
+            }
+        }
+
+        return tasks;
+    }
+
+    FileResult Batch::stitch(Task* chunks, size_t numChunks)
+    {
+        FileResult result = std::move(chunks[0].result);
+        if (result.error.isNotEmpty())
+            return result;
+
+        const int cooldown = OfflineDetector::getCooldownSamples(result.sampleRate);
+        juce::int64 cooldownEnd = chunks[0].seam.cooldownAtEnd;
+
+        for (size_t index = 1; index < numChunks; ++index) {
+            auto& chunk = chunks[index];
+            if (chunk.result.error.isNotEmpty()) {
+                result.error = chunk.result.error;
+                result.events.clear();
+                return result;
+            }
+
+            result.decodeSeconds += chunk.result.decodeSeconds;
+            result.analysisSeconds += chunk.result.analysisSeconds;
+            result.numBytes += chunk.result.numBytes;
+
+            // Cooldowns ending before the start are equivalent: nothing earlier is decided here
+            if (std::max(chunk.seam.cooldownAtStart, chunk.start) == std::max(cooldownEnd, chunk.start)) {
+                result.events.insert(result.events.end(), chunk.result.events.begin(), chunk.result.events.end());
+                cooldownEnd = chunk.seam.cooldownAtEnd;
+                continue;
+            }
+
+            // The overlap did not settle the cooldown (steps closer than the cooldown all
+            // through it): apply it again from where the previous chunk left it
+            for (const auto& candidate : chunk.seam.candidates) {
+                if (candidate.position >= cooldownEnd) {
+                    result.events.push_back(makeEvent(candidate.position, candidate.onsetAge, candidate.confidence, result.sampleRate));
+                    cooldownEnd = candidate.position + cooldown + 1;
+                }
+            }
+        }
+
+        return result;
+    }
+
+    std::vector<FileResult> Batch::analyse(const juce::Array<juce::File>& files, const std::function<void(const FileResult&)>& onFileDone)
+    {
+        std::vector<FileResult> results(static_cast<size_t>(files.size()));
+        auto tasks = split(files);
+
+        // A file's chunks are consecutive tasks
+        std::vector<size_t> firstTask(results.size(), 0), numTasks(results.size(), 0);
+        for (size_t index = tasks.size(); index-- > 0;) {
+            firstTask[static_cast<size_t>(tasks[index].file)] = index;
+            numTasks[static_cast<size_t>(tasks[index].file)]++;
+        }
+        auto tasksLeft = numTasks;
+
+        // Largest first, so the long files start early and the short ones fill the gaps
+        std::vector<int> order(tasks.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&tasks](int a, int b) {
+            return tasks[static_cast<size_t>(a)].size > tasks[static_cast<size_t>(b)].size;
+        });
+
+        pool.run(order, [&](int worker, int index) {
+            auto& task = tasks[static_cast<size_t>(index)];
+            auto& analyzer = *analyzers[static_cast<size_t>(worker)];
+            const auto& file = files[task.file];
+
+            task.result = task.end < 0 ? analyzer.analyse(file) : analyzer.analyse(file, task.start, task.end, task.seam);
+
+            // The worker finishing a file's last chunk stitches it
+            std::lock_guard<std::mutex> lock(completionLock);
+            const auto fileIndex = static_cast<size_t>(task.file);
+            if (--tasksLeft[fileIndex] > 0)
+                return;
+
+            auto& result = results[fileIndex];
+            if (task.end < 0)
+                result = std::move(task.result);
+            else
+                result = stitch(tasks.data() + firstTask[fileIndex], numTasks[fileIndex]);
+
+            if (onFileDone != nullptr)
+                onFileDone(result);
+        });
+
+        return results;
+    }
+
+    juce::Array<juce::File> findAudioFiles(const juce::StringArray& paths, juce::AudioFormatManager& formats)
+    {
+        const auto wildcard = formats.getWildcardForAllFormats();
+        juce::Array<juce::File> files;
+
+        for (const auto& path : paths) {
+            const auto location = juce::File::getCurrentWorkingDirectory().getChildFile(path);
+
+            if (location.isDirectory()) {
+                auto found = location.findChildFiles(juce::File::findFiles, true, wildcard);
+                found.sort();
+                files.addArray(found);
+            } else {
+                files.add(location);    // missing or unreadable files are reported by analyse
+            }
+        }
+
+        return files;
+    }
+
+    void writeCsv(std::ostream& out, const std::vector<FileResult>& results)
+    {
+        out << "file,duration_s,sample_rate,channels,model,rtf,event,time_s,onset_s,confidence" << std::endl;
+
+        for (const auto& result : results) {
+            if (result.error.isNotEmpty())
+                continue;
+
+            std::ostringstream summary;
+            summary << quoteCsv(result.file.getFullPathName()) << std::fixed << std::setprecision(3)
+                    << ',' << result.getDurationSeconds() << ',' << std::setprecision(0) << result.sampleRate
+                    << ',' << result.numChannels << ',' << quoteCsv(result.model)
+                    << ',' << std::setprecision(5) << result.getRealTimeFactor();
+
+            if (result.events.empty())
+                out << summary.str() << ",,,," << std::endl;
+
+            for (size_t index = 0; index < result.events.size(); ++index) {
+                const auto& event = result.events[index];
+                out << summary.str() << ',' << index << std::setprecision(4) << ',' << event.seconds
+                    << ',' << event.onsetSeconds << ',' << std::setprecision(3) << event.confidence << std::endl;
+            }
+        }
+    }
+
+    void writeJson(std::ostream& out, const Config& config, const std::vector<FileResult>& results)
+    {
+        auto* configObject = new juce::DynamicObject();
+        configObject->setProperty("tier", config.tier);
+        configObject->setProperty("sensitivity", config.sensitivity);
+        configObject->setProperty("high_accuracy", config.highAccuracy);
+        configObject->setProperty("block_size", config.blockSize);
+        configObject->setProperty("quantized_forest", config.quantizedForest);
+
+        juce::Array<juce::var> files;
+        for (const auto& result : results) {
+            auto* fileObject = new juce::DynamicObject();
+            fileObject->setProperty("file", result.file.getFullPathName());
+
+            if (result.error.isNotEmpty()) {
+                fileObject->setProperty("error", result.error);
+                files.add(juce::var(fileObject));
+                continue;
+            }
+
+            fileObject->setProperty("format", result.format);
+            fileObject->setProperty("model", result.model);
+            fileObject->setProperty("sample_rate", result.sampleRate);
+            fileObject->setProperty("channels", result.numChannels);
+            fileObject->setProperty("duration_s", result.getDurationSeconds());
+            fileObject->setProperty("decode_s", result.decodeSeconds);
+            fileObject->setProperty("analysis_s", result.analysisSeconds);
+            fileObject->setProperty("rtf", result.getRealTimeFactor());
+            fileObject->setProperty("ingest", result.memoryMapped ? "mapped" : "streamed");
+            fileObject->setProperty("ingest_gb_s", result.getIngestRate());
+
+            juce::Array<juce::var> events;
+            for (const auto& event : result.events) {
+                auto* eventObject = new juce::DynamicObject();
+                eventObject->setProperty("time_s", event.seconds);
+                eventObject->setProperty("onset_s", event.onsetSeconds);
+                eventObject->setProperty("confidence", event.confidence);
+                events.add(juce::var(eventObject));
+            }
+            fileObject->setProperty("events", events);
+            files.add(juce::var(fileObject));
+        }
+
+        auto* root = new juce::DynamicObject();
+        root->setProperty("config", juce::var(configObject));
+        root->setProperty("files", files);
+
+        out << juce::JSON::toString(juce::var(root)) << std::endl;
+    }
+}
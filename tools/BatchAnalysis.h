@@ -0,0 +1,179 @@
+#pragma once
+
+#include <juce_audio_formats/juce_audio_formats.h>
+#include "MappedAudio.h"
+#include "MLFootstepClassifier.h"
+#include "ModelRegistry.h"
+#include "OfflineDetector.h"
+#include "SpeakerGroups.h"
+#include "WorkStealingPool.h"
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+// BATCH ANALYSIS: the plugin's detection pipeline run over audio files as fast as
+// it goes. Files are decoded in blocks by juce_audio_formats (FLAC, Ogg), sanitised
+// and downmixed over every non-LFE channel (the "All Speakers" analysis mix); WAV
+// and AIFF are memory-mapped and mixed straight from the mapped pages instead (see
+// MappedAudio), with the same result. The mix is fed to an MLFootstepClassifier
+// with the plugin's hop schedule, hold-off and model tiers. With highAccuracy the
+// OfflineDetector of the plugin's offline render mode scores every hop with the
+// same tier instead.
+//
+// High-accuracy files longer than chunkSeconds are split into chunks that run in
+// parallel. Each chunk starts its detector getOverlap() samples early: a window to
+// fill the history, then the cooldown and hold span to settle the cooldown. Events
+// in the overlap belong to the previous chunk and are dropped. At each seam the
+// warmed-up cooldown is checked against where the previous chunk left it, and in
+// the rare case they differ the chunk's cooldown is applied again from the right
+// state, so the events are bit-identical to one sequential pass. The streaming
+// detector keeps activity envelopes and an adaptive hop from the very first sample,
+// which no finite overlap reproduces, so its files are never split.
+namespace BatchAnalysis
+{
+    struct Config
+    {
+        int tier = 0;                   // as "modelTier": 0 = built-in weights, 1-3 = registry tiers
+        float sensitivity = 0.8f;       // the plugin's default
+        bool highAccuracy = false;      // offline render mode (every hop)
+        int blockSize = 4096;
+        juce::File modelDirectory;      // JSON exports loaded over the compiled-in models (optional)
+        double chunkSeconds = 30.0;     // high accuracy: longer files are split (0 = never)
+        bool quantizedForest = false;   // int16 forest inference (ModelRegistry::setQuantizedForests)
+    };
+
+    struct Event
+    {
+        double seconds;                 // sample that triggered the detection
+        double onsetSeconds;            // estimated attack of the step
+        float confidence;
+    };
+
+    struct FileResult
+    {
+        juce::File file;
+        juce::String error;             // empty when the file was analysed
+        juce::String format;
+        juce::String model;
+        double sampleRate = 0.0;
+        int numChannels = 0;
+        juce::int64 numSamples = 0;
+        bool memoryMapped = false;      // read from the mapped file rather than decoded
+        juce::int64 numBytes = 0;       // PCM read (decoded size for compressed files)
+        double decodeSeconds = 0.0;     // opening, reading and downmixing
+        double analysisSeconds = 0.0;
+        std::vector<Event> events;
+
+        double getDurationSeconds() const { return sampleRate > 0.0 ? double(numSamples) / sampleRate : 0.0; }
+
+        // Processing time over audio duration (0.01 = a hundred times faster than real time)
+        double getRealTimeFactor() const;
+
+        // PCM ingested per second of decoding, in GB/s
+        double getIngestRate() const;
+    };
+
+    // Where a chunk meets its neighbours, for stitching the chunks of a file together
+    struct Seam
+    {
+        struct Candidate
+        {
+            juce::int64 position;
+            int onsetAge;
+            float confidence;
+        };
+
+        juce::int64 cooldownAtStart = 0;    // first sample free to trigger, as warmed up on the overlap
+        juce::int64 cooldownAtEnd = 0;      // the same after the chunk's last sample
+        std::vector<Candidate> candidates;  // footstep decisions in the chunk, before the cooldown
+    };
+
+    // One detector with its model registry and buffers. Files are analysed one after
+    // another; use one Analyzer per thread.
+    class Analyzer
+    {
+    public:
+        explicit Analyzer(const Config& config);
+        ~Analyzer();
+
+        FileResult analyse(const juce::File& file);
+
+        // High accuracy only: the events in samples [start, end) of a file, with the
+        // detector started getOverlap() samples before start (on the hop grid)
+        FileResult analyse(const juce::File& file, juce::int64 start, juce::int64 end, Seam& seam);
+
+        // Analysis window plus cooldown and hold, in samples
+        static juce::int64 getOverlap(double sampleRate);
+
+        juce::AudioFormatManager& getFormats() { return formats; }
+
+    private:
+        Config config;
+        juce::AudioFormatManager formats;
+        ModelRegistry registry;
+        MLFootstepClassifier classifier;
+        OfflineDetector offlineDetector;
+        SpeakerGroups speakerGroups;
+        MappedAudio mappedAudio;
+        juce::AudioBuffer<float> block;         // decoded blocks of unmapped files
+        std::vector<float> analysis;
+
+        const FootstepModel* getModel() const;
+        FileResult analyseRange(const juce::File& file, juce::int64 start, juce::int64 end, Seam* seam);
+        void readDownmix(juce::AudioFormatReader& reader, juce::int64 position, int numSamples, const std::vector<int>& channels);
+        void detect(const float* samples, int numSamples, juce::int64 position, juce::int64 start, double sampleRate,
+                    FileResult& result, Seam* seam);
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Analyzer)
+    };
+
+    // A batch on a work-stealing pool, one Analyzer (detector and buffers) per worker.
+    // Files (or chunks of them) are scheduled largest first; results come back in the
+    // order given.
+    class Batch
+    {
+    public:
+        Batch(const Config& config, int numThreads);
+        ~Batch();
+
+        int getNumThreads() const { return pool.getNumWorkers(); }
+        juce::AudioFormatManager& getFormats() { return analyzers.front()->getFormats(); }
+
+        // onFileDone is called as each file finishes (with all its chunks), from any
+        // worker, one call at a time
+        std::vector<FileResult> analyse(const juce::Array<juce::File>& files,
+                                        const std::function<void(const FileResult&)>& onFileDone = nullptr);
+
+        long long getNumSteals() const { return pool.getNumSteals(); }
+
+    private:
+        struct Task
+        {
+            int file = 0;
+            juce::int64 start = 0;
+            juce::int64 end = -1;       // -1: the whole file, unchunked
+            double size = 0.0;          // bytes, for the schedule
+            FileResult result;
+            Seam seam;
+        };
+
+        Config config;
+        std::vector<std::unique_ptr<Analyzer>> analyzers;
+        WorkStealingPool pool;
+        std::mutex completionLock;      // chunk counts and onFileDone
+
+        std::vector<Task> split(const juce::Array<juce::File>& files);
+        static FileResult stitch(Task* chunks, size_t numChunks);
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Batch)
+    };
+
+    // Files the format manager can open: files as given, directories searched recursively
+    juce::Array<juce::File> findAudioFiles(const juce::StringArray& paths, juce::AudioFormatManager& formats);
+
+    // CSV: one row per event, with the file's summary repeated; files without events
+    // get one row with the event columns empty
+    void writeCsv(std::ostream& out, const std::vector<FileResult>& results);
+    void writeJson(std::ostream& out, const Config& config, const std::vector<FileResult>& results);
+}
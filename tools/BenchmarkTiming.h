@@ -0,0 +1,128 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+// Helpers shared by the benchmark and evaluation tools: timing, a quiet stdout,
+// plugin parameters, onset labels and the synthetic footstep recording
+namespace BenchmarkTiming
+{
+    struct TimingStats
+    {
+        double meanMicros = 0.0;
+        double p50Micros = 0.0;
+        double p90Micros = 0.0;
+        double p99Micros = 0.0;
+        double maxMicros = 0.0;
+    };
+
+    // Calls are timed in batches so sub-microsecond work stays above timer resolution
+    template <typename Function>
+    TimingStats measure(Function&& function, int iterations, int batchSize = 1)
+    {
+        const int warmup = std::max(1, iterations / 10);
+        for (int i = 0; i < warmup; ++i)
+            function();
+
+        std::vector<double> samples(static_cast<size_t>(iterations));
+        for (auto& sample : samples) {
+            auto start = juce::Time::getHighResolutionTicks();
+            for (int call = 0; call < batchSize; ++call)
+                function();
+            sample = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start) * 1.0e6 / batchSize;
+        }
+
+        std::sort(samples.begin(), samples.end());
+
+        TimingStats stats;
+        for (double sample : samples)
+            stats.meanMicros += sample;
+        stats.meanMicros /= iterations;
+        stats.p50Micros = samples[samples.size() / 2];
+        stats.p90Micros = samples[std::min(samples.size() - 1, samples.size() * 90 / 100)];
+        stats.p99Micros = samples[std::min(samples.size() - 1, samples.size() * 99 / 100)];
+        stats.maxMicros = samples.back();
+        return stats;
+    }
+
+    inline double millisecondsSince(juce::int64 startTicks)
+    {
+        return juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) * 1000.0;
+    }
+
+    // The detector and processor log heavily; keep them out of the report while running
+    struct ScopedSilence
+    {
+        ScopedSilence() : coutBuffer(std::cout.rdbuf(nullptr)) {}
+        ~ScopedSilence() { std::cout.rdbuf(coutBuffer); }
+
+        std::streambuf* coutBuffer;
+    };
+
+    // Sets a FootstepDetectorAudioProcessor parameter in its own units, as a host would
+    template <typename Processor>
+    void setParameter(Processor& processor, const char* id, float value)
+    {
+        auto* parameter = processor.parameters.getParameter(id);
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    }
+
+    // Onset labels: one time in seconds per line (first column, header optional),
+    // returned in samples, ascending
+    inline std::vector<juce::int64> readOnsetLabels(const juce::File& labelFile, double sampleRate)
+    {
+        std::vector<juce::int64> onsets;
+        juce::StringArray lines;
+        labelFile.readLines(lines);
+        for (auto& line : lines) {
+            auto field = line.upToFirstOccurrenceOf(",", false, false).trim();
+            if (field.isNotEmpty() && field.containsOnly("0123456789.eE+-"))
+                onsets.push_back(static_cast<juce::int64>(field.getDoubleValue() * sampleRate));
+        }
+
+        std::sort(onsets.begin(), onsets.end());
+        return onsets;
+    }
+
+    // Stereo footsteps with known onsets: thumps (1 ms attack, 90 and 210 Hz body with
+    // some noise, 40 ms decay) every 0.45 to 0.65 s over a quiet noise floor. The onset
+    // samples go to onsets when given.
+    inline juce::AudioBuffer<float> synthesizeFootsteps(double sampleRate, double seconds, int seed,
+                                                        std::vector<juce::int64>* onsets = nullptr)
+    {
+        juce::AudioBuffer<float> audio(2, static_cast<int>(sampleRate * seconds));
+
+        juce::Random random(seed);
+        for (int channel = 0; channel < 2; ++channel)
+            for (int i = 0; i < audio.getNumSamples(); ++i)
+                audio.setSample(channel, i, (random.nextFloat() * 2.0f - 1.0f) * 0.004f);
+
+        const int attack = static_cast<int>(sampleRate * 0.001);
+        const int length = static_cast<int>(sampleRate * 0.2);
+
+        for (double time = 0.5; time < seconds - 0.5; time += 0.45 + random.nextDouble() * 0.2) {
+            const auto onset = static_cast<juce::int64>(time * sampleRate);
+            if (onsets != nullptr)
+                onsets->push_back(onset);
+
+            const float level = 0.25f + random.nextFloat() * 0.2f;
+            for (int i = 0; i < length && onset + i < audio.getNumSamples(); ++i) {
+                const double t = i / sampleRate;
+                const double envelope = (i < attack ? double(i) / attack : 1.0) * std::exp(-t / 0.04);
+                const double body = std::sin(2.0 * juce::MathConstants<double>::pi * 90.0 * t)
+                                  + 0.6 * std::sin(2.0 * juce::MathConstants<double>::pi * 210.0 * t)
+                                  + 0.3 * (random.nextDouble() * 2.0 - 1.0);
+                const float value = static_cast<float>(level * envelope * body / 1.9);
+
+                for (int channel = 0; channel < 2; ++channel)
+                    audio.addSample(channel, static_cast<int>(onset) + i, value);
+            }
+        }
+
+        return audio;
+    }
+}
@@ -0,0 +1,349 @@
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_audio_formats/juce_audio_formats.h>
+#include "OnsetEvaluation.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+
+// Scores the streaming detector against labelled footstep onsets: detection
+// quality, how soon the enhancement engages, and what it costs, one row per
+// configuration so the trade-offs read off a single table.
+//
+// Usage: DetectionEvaluation [audio onsets.csv ...] [--tiers=0,1,2,3] [--sensitivity=0.8]
+//                            [--lookahead=0] [--tolerance=25,50,100] [--block=N]
+//                            [--background=budgetMs] [--offline] [--output=<file.csv|file.json>]
+//
+// Inputs are audio / label pairs; the CSV holds one onset time in seconds per line
+// (first column, header optional, no onsets = a recording that should stay silent).
+// Without files 30 s of BenchmarkTiming::synthesizeFootsteps are used. The
+// configurations are every combination of --tiers, --sensitivity and --lookahead;
+// each runs over every input through a fresh processor in --block sized blocks
+// (default 512), with the CPU guard off so results do not depend on machine load.
+//
+// A detection is an engagement of the enhancement: the first output sample that
+// differs from the input delayed by the reported latency (and limited to +/-0.9,
+// as the processor limits every output), after at least 10 ms without any
+// difference. Detections and onsets are paired one to one, closest
+// first, within each --tolerance window (ms): precision, recall and F1 follow. The
+// delay distribution (detection - onset, negative = early, in ms) is over the pairs
+// of the widest window; the reported latency comes on top of it at the output.
+//
+// CPU is processBlock time over audio time, plus the p99 of a block in us.
+// Events/min counts all detections, matched or not.
+//
+// --background runs detection on the background worker with the given latency
+// budget, with the blocks paced in real time (the worker's time is not in the CPU
+// columns). --offline renders as a non-realtime bounce (every hop scored).
+// --output writes the table as CSV, or as JSON when the file ends in .json.
+
+namespace
+{
+    using OnsetEvaluation::Recording;
+    using OnsetEvaluation::percentile;
+
+    struct Config
+    {
+        int tier = 0;
+        float sensitivity = 0.8f;
+        float lookaheadMs = 0.0f;
+
+        juce::String getName() const
+        {
+            return "tier " + juce::String(tier) + " s" + juce::String(sensitivity, 2) + " la" + juce::String(lookaheadMs, 0);
+        }
+    };
+
+    struct Score
+    {
+        int matched = 0;
+        double precision = 0.0, recall = 0.0, f1 = 0.0;
+    };
+
+    struct Row
+    {
+        Config config;
+        int latency = 0;                    // samples, of the last input
+        int numOnsets = 0;
+        int numDetections = 0;
+        std::vector<Score> scores;          // per tolerance
+        std::vector<double> delays;         // ms, pairs within the widest tolerance
+        double audioSeconds = 0.0;
+        double processSeconds = 0.0;
+        std::vector<double> blockMicros;
+        juce::int64 fallbacks = 0;
+    };
+
+    // One-to-one pairs (onset index, detection index) within the window, closest first
+    std::vector<std::pair<size_t, size_t>> match(const std::vector<juce::int64>& onsets,
+                                                 const std::vector<juce::int64>& detections, juce::int64 window)
+    {
+        struct Candidate { juce::int64 distance; size_t onset, detection; };
+        std::vector<Candidate> candidates;
+
+        size_t first = 0;
+        for (size_t onset = 0; onset < onsets.size(); ++onset) {
+            while (first < detections.size() && detections[first] < onsets[onset] - window)
+                first++;
+            for (size_t detection = first; detection < detections.size() && detections[detection] <= onsets[onset] + window; ++detection)
+                candidates.push_back({ std::abs(detections[detection] - onsets[onset]), onset, detection });
+        }
+
+        std::stable_sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+            return a.distance < b.distance;
+        });
+
+        std::vector<bool> onsetUsed(onsets.size(), false), detectionUsed(detections.size(), false);
+        std::vector<std::pair<size_t, size_t>> pairs;
+        for (const auto& candidate : candidates) {
+            if (onsetUsed[candidate.onset] || detectionUsed[candidate.detection])
+                continue;
+            onsetUsed[candidate.onset] = detectionUsed[candidate.detection] = true;
+            pairs.emplace_back(candidate.onset, candidate.detection);
+        }
+
+        return pairs;
+    }
+
+    double getCpuPercent(const Row& row)
+    {
+        return row.audioSeconds > 0.0 ? 100.0 * row.processSeconds / row.audioSeconds : 0.0;
+    }
+
+    double getEventsPerMinute(const Row& row)
+    {
+        return row.audioSeconds > 0.0 ? row.numDetections * 60.0 / row.audioSeconds : 0.0;
+    }
+
+    void writeCsv(std::ostream& out, const std::vector<Row>& rows, const std::vector<double>& tolerances)
+    {
+        out << "tier,sensitivity,lookahead_ms,latency_samples,onsets,detections";
+        for (double tolerance : tolerances)
+            out << ",precision_" << tolerance << "ms,recall_" << tolerance << "ms,f1_" << tolerance << "ms";
+        out << ",delay_p10_ms,delay_p50_ms,delay_p90_ms,delay_max_ms,cpu_percent,block_p99_us,events_per_minute" << std::endl;
+
+        for (const auto& row : rows) {
+            out << row.config.tier << "," << row.config.sensitivity << "," << row.config.lookaheadMs << ","
+                << row.latency << "," << row.numOnsets << "," << row.numDetections;
+            for (const auto& score : row.scores)
+                out << "," << score.precision << "," << score.recall << "," << score.f1;
+            out << "," << percentile(row.delays, 0.1) << "," << percentile(row.delays, 0.5) << "," << percentile(row.delays, 0.9)
+                << "," << percentile(row.delays, 1.0) << "," << getCpuPercent(row) << "," << percentile(row.blockMicros, 0.99)
+                << "," << getEventsPerMinute(row) << std::endl;
+        }
+    }
+
+    void writeJson(std::ostream& out, const std::vector<Row>& rows, const std::vector<double>& tolerances,
+                   const juce::StringArray& inputs, int blockSize)
+    {
+        auto* root = new juce::DynamicObject();
+        root->setProperty("inputs", inputs);
+        root->setProperty("block_size", blockSize);
+
+        juce::Array<juce::var> results;
+        for (const auto& row : rows) {
+            auto* result = new juce::DynamicObject();
+            result->setProperty("tier", row.config.tier);
+            result->setProperty("sensitivity", row.config.sensitivity);
+            result->setProperty("lookahead_ms", row.config.lookaheadMs);
+            result->setProperty("latency_samples", row.latency);
+            result->setProperty("onsets", row.numOnsets);
+            result->setProperty("detections", row.numDetections);
+
+            juce::Array<juce::var> scores;
+            for (size_t t = 0; t < tolerances.size(); ++t) {
+                auto* score = new juce::DynamicObject();
+                score->setProperty("tolerance_ms", tolerances[t]);
+                score->setProperty("matched", row.scores[t].matched);
+                score->setProperty("precision", row.scores[t].precision);
+                score->setProperty("recall", row.scores[t].recall);
+                score->setProperty("f1", row.scores[t].f1);
+                scores.add(juce::var(score));
+            }
+            result->setProperty("scores", scores);
+
+            auto* delay = new juce::DynamicObject();
+            delay->setProperty("p10", percentile(row.delays, 0.1));
+            delay->setProperty("p50", percentile(row.delays, 0.5));
+            delay->setProperty("p90", percentile(row.delays, 0.9));
+            delay->setProperty("max", percentile(row.delays, 1.0));
+            result->setProperty("delay_ms", juce::var(delay));
+
+            result->setProperty("cpu_percent", getCpuPercent(row));
+            result->setProperty("block_p99_us", percentile(row.blockMicros, 0.99));
+            result->setProperty("events_per_minute", getEventsPerMinute(row));
+            if (row.fallbacks > 0)
+                result->setProperty("fallbacks", row.fallbacks);
+            results.add(juce::var(result));
+        }
+        root->setProperty("results", results);
+
+        out << juce::JSON::toString(juce::var(root)) << std::endl;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList args(argc, argv);
+
+    juce::StringArray paths;
+    for (const auto& argument : args.arguments)
+        if (!argument.isOption())
+            paths.add(argument.text);
+
+    if (paths.size() % 2 != 0) {
+        std::cerr << "Usage: DetectionEvaluation [audio onsets.csv ...] [--tiers=0,1,2,3] [--sensitivity=0.8] [--lookahead=0]" << std::endl
+                  << "                           [--tolerance=25,50,100] [--block=N] [--background=budgetMs] [--offline]" << std::endl
+                  << "                           [--output=<file.csv|file.json>]" << std::endl;
+        return 1;
+    }
+
+    std::vector<Recording> recordings;
+    for (int i = 0; i < paths.size(); i += 2) {
+        const auto audioFile = juce::File::getCurrentWorkingDirectory().getChildFile(paths[i]);
+        const auto labelFile = juce::File::getCurrentWorkingDirectory().getChildFile(paths[i + 1]);
+
+        recordings.emplace_back();
+        if (!OnsetEvaluation::load(audioFile, labelFile, recordings.back())) {
+            std::cerr << "Failed to load " << paths[i] << " or " << paths[i + 1] << std::endl;
+            return 1;
+        }
+    }
+    if (recordings.empty())
+        recordings.push_back(OnsetEvaluation::synthesize(44100.0, 30.0));
+
+    auto listOption = [&](const char* option, const char* fallback) {
+        return juce::StringArray::fromTokens(args.containsOption(option) ? args.getValueForOption(option) : juce::String(fallback), ",", {});
+    };
+
+    std::vector<Config> configs;
+    for (auto& tier : listOption("--tiers", "0,1,2,3"))
+        for (auto& sensitivity : listOption("--sensitivity", "0.8"))
+            for (auto& lookahead : listOption("--lookahead", "0")) {
+                Config config;
+                config.tier = juce::jlimit(0, FootstepModel::NUM_TIERS, tier.getIntValue());
+                config.sensitivity = juce::jlimit(0.0f, 1.0f, sensitivity.getFloatValue());
+                config.lookaheadMs = juce::jmax(0.0f, lookahead.getFloatValue());
+                configs.push_back(config);
+            }
+
+    std::vector<double> tolerances;
+    for (auto& tolerance : listOption("--tolerance", "25,50,100"))
+        if (tolerance.getDoubleValue() > 0.0)
+            tolerances.push_back(tolerance.getDoubleValue());
+    std::sort(tolerances.begin(), tolerances.end());
+    if (tolerances.empty())
+        tolerances.push_back(50.0);
+
+    const int blockSize = args.containsOption("--block") ? juce::jmax(16, args.getValueForOption("--block").getIntValue()) : 512;
+    const float budgetMs = args.containsOption("--background") ? juce::jmax(0.0f, args.getValueForOption("--background").getFloatValue()) : -1.0f;
+    const bool offline = args.containsOption("--offline");
+
+    juce::StringArray inputs;
+    size_t numOnsets = 0;
+    double seconds = 0.0;
+    for (const auto& recording : recordings) {
+        inputs.add(recording.name);
+        numOnsets += recording.onsets.size();
+        seconds += recording.audio.getNumSamples() / recording.sampleRate;
+    }
+
+    std::vector<Row> rows;
+    for (const auto& config : configs)
+    {
+        Row row;
+        row.config = config;
+        row.scores.resize(tolerances.size());
+
+        for (const auto& recording : recordings) {
+            OnsetEvaluation::RenderSettings settings;
+            settings.tier = config.tier;
+            settings.sensitivity = config.sensitivity;
+            settings.lookaheadMs = config.lookaheadMs;
+            settings.blockSize = blockSize;
+            settings.budgetMs = budgetMs;
+            settings.offline = offline;
+
+            const auto rendered = OnsetEvaluation::render(recording, settings);
+            const auto detections = OnsetEvaluation::findGainStarts(recording, rendered);
+            const double toMillis = 1000.0 / recording.sampleRate;
+
+            row.latency = rendered.latency;
+            row.fallbacks += rendered.fallbacks;
+            row.audioSeconds += recording.audio.getNumSamples() / recording.sampleRate;
+            for (double micros : rendered.blockMicros) {
+                row.processSeconds += micros * 1.0e-6;
+                row.blockMicros.push_back(micros);
+            }
+
+            row.numOnsets += static_cast<int>(recording.onsets.size());
+            row.numDetections += static_cast<int>(detections.size());
+
+            for (size_t t = 0; t < tolerances.size(); ++t) {
+                const auto pairs = match(recording.onsets, detections, static_cast<juce::int64>(tolerances[t] / toMillis));
+                row.scores[t].matched += static_cast<int>(pairs.size());
+
+                if (t + 1 == tolerances.size())
+                    for (const auto& pair : pairs)
+                        row.delays.push_back(double(detections[pair.second] - recording.onsets[pair.first]) * toMillis);
+            }
+        }
+
+        for (auto& score : row.scores) {
+            score.precision = row.numDetections > 0 ? double(score.matched) / row.numDetections : 0.0;
+            score.recall = row.numOnsets > 0 ? double(score.matched) / row.numOnsets : 0.0;
+            score.f1 = score.precision + score.recall > 0.0 ? 2.0 * score.precision * score.recall / (score.precision + score.recall) : 0.0;
+        }
+
+        rows.push_back(std::move(row));
+    }
+
+    std::cout << std::endl << "DETECTION EVALUATION (" << recordings.size() << " inputs, " << numOnsets << " onsets, "
+              << std::fixed << std::setprecision(1) << seconds << " s, block " << blockSize;
+    if (budgetMs >= 0.0f)
+        std::cout << ", background analysis, " << budgetMs << " ms budget";
+    if (offline)
+        std::cout << ", offline render";
+    std::cout << ")" << std::endl;
+
+    std::cout << std::left << std::setw(20) << "Config" << std::right << std::setw(8) << "Latency" << std::setw(6) << "Det";
+    for (double tolerance : tolerances)
+        std::cout << std::setw(18) << ("P/R/F1@" + juce::String(tolerance, 0) + "ms");
+    std::cout << std::setw(10) << "P10(ms)" << std::setw(10) << "P50(ms)" << std::setw(10) << "P90(ms)" << std::setw(10) << "Max(ms)"
+              << std::setw(8) << "CPU%" << std::setw(11) << "P99(us)" << std::setw(9) << "Ev/min";
+    if (budgetMs >= 0.0f)
+        std::cout << std::setw(11) << "Fallbacks";
+    std::cout << std::endl;
+
+    for (const auto& row : rows) {
+        std::cout << std::left << std::setw(20) << row.config.getName() << std::right << std::setw(8) << row.latency
+                  << std::setw(6) << row.numDetections << std::setprecision(2);
+        for (const auto& score : row.scores)
+            std::cout << std::setw(18) << (juce::String(score.precision, 2) + "/" + juce::String(score.recall, 2) + "/" + juce::String(score.f1, 2));
+        std::cout << std::setw(10) << percentile(row.delays, 0.1) << std::setw(10) << percentile(row.delays, 0.5)
+                  << std::setw(10) << percentile(row.delays, 0.9) << std::setw(10) << percentile(row.delays, 1.0)
+                  << std::setw(8) << getCpuPercent(row) << std::setprecision(1) << std::setw(11) << percentile(row.blockMicros, 0.99)
+                  << std::setw(9) << getEventsPerMinute(row);
+        if (budgetMs >= 0.0f)
+            std::cout << std::setw(11) << row.fallbacks;
+        std::cout << std::endl;
+    }
+
+    if (args.containsOption("--output")) {
+        const auto file = juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--output"));
+        std::ofstream out(file.getFullPathName().toStdString());
+        if (!out) {
+            std::cerr << "Cannot write " << file.getFullPathName() << std::endl;
+            return 1;
+        }
+
+        if (file.hasFileExtension("json"))
+            writeJson(out, rows, tolerances, inputs, blockSize);
+        else
+            writeCsv(out, rows, tolerances);
+    }
+
+    return 0;
+}
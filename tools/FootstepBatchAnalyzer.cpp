@@ -0,0 +1,129 @@
+#include <juce_core/juce_core.h>
+#include <juce_audio_formats/juce_audio_formats.h>
+#include "BatchAnalysis.h"
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+
+// Headless footstep scan of recorded audio with the plugin's detection pipeline.
+//
+// Usage: FootstepBatchAnalyzer <audio files or directories...> [--format=csv|json]
+//                              [--output=<file>] [--tier=N] [--sensitivity=S]
+//                              [--high-accuracy] [--block=N] [--models=<dir>] [--threads=N]
+//                              [--chunk=<seconds>] [--quantized]
+//
+// Directories are searched recursively for every format juce_audio_formats reads
+// (WAV, AIFF, FLAC, Ogg Vorbis); WAV and AIFF are memory-mapped rather than
+// decoded. Each file runs through the detector unpaced; the events (detection and
+// estimated onset times, confidence) and the file's real-time factor (decode plus
+// analysis time over duration) go to --output, or to stdout. --tier and
+// --sensitivity mean what the plugin parameters do; --high-accuracy uses the
+// offline render mode instead (the same tier, every hop). --quantized runs the full
+// forest on int16 features and thresholds. Progress and the totals,
+// with the ingest rate in GB/s, are printed to stderr. Exits with 1 when any file
+// could not be analysed.
+//
+// Files are spread over --threads workers (default: one per core) on a
+// work-stealing pool, each with its own detector; the output keeps the file order.
+// With --high-accuracy, files longer than --chunk seconds (default 30, 0 = never)
+// are split into overlapping chunks on the same pool and stitched back together;
+// the events are identical to analysing the file in one pass.
+
+int main(int argc, char* argv[])
+{
+    juce::ArgumentList args(argc, argv);
+
+    juce::StringArray paths;
+    for (const auto& argument : args.arguments)
+        if (!argument.isOption())
+            paths.add(argument.text);
+
+    const juce::String format = args.containsOption("--format") ? args.getValueForOption("--format").toLowerCase() : juce::String("csv");
+
+    if (paths.isEmpty() || (format != "csv" && format != "json")) {
+        std::cerr << "Usage: FootstepBatchAnalyzer <audio files or directories...> [--format=csv|json] [--output=<file>]" << std::endl
+                  << "                             [--tier=N] [--sensitivity=S] [--high-accuracy] [--block=N] [--models=<dir>]" << std::endl
+                  << "                             [--threads=N] [--chunk=<seconds>] [--quantized]" << std::endl;
+        return 1;
+    }
+
+    BatchAnalysis::Config config;
+    if (args.containsOption("--tier"))
+        config.tier = juce::jlimit(0, FootstepModel::NUM_TIERS, args.getValueForOption("--tier").getIntValue());
+    if (args.containsOption("--sensitivity"))
+        config.sensitivity = juce::jlimit(0.0f, 1.0f, args.getValueForOption("--sensitivity").getFloatValue());
+    if (args.containsOption("--block"))
+        config.blockSize = args.getValueForOption("--block").getIntValue();
+    if (args.containsOption("--models"))
+        config.modelDirectory = juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--models"));
+    if (args.containsOption("--chunk"))
+        config.chunkSeconds = juce::jmax(0.0, args.getValueForOption("--chunk").getDoubleValue());
+    config.highAccuracy = args.containsOption("--high-accuracy");
+    config.quantizedForest = args.containsOption("--quantized");
+
+    const int numThreads = args.containsOption("--threads") ? juce::jmax(1, args.getValueForOption("--threads").getIntValue())
+                                                            : juce::SystemStats::getNumCpus();
+
+    // The detector logs heavily: std::cout is muted, results go to the real stdout or the file
+    std::streambuf* stdoutBuffer = std::cout.rdbuf(nullptr);
+    std::ofstream outputFile;
+    if (args.containsOption("--output")) {
+        outputFile.open(juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--output")).getFullPathName().toStdString());
+        if (!outputFile) {
+            std::cerr << "Cannot write " << args.getValueForOption("--output") << std::endl;
+            return 1;
+        }
+    }
+    std::ostream out(outputFile.is_open() ? outputFile.rdbuf() : stdoutBuffer);
+
+    BatchAnalysis::Batch batch(config, numThreads);
+    const auto files = BatchAnalysis::findAudioFiles(paths, batch.getFormats());
+
+    double audioSeconds = 0.0, processingSeconds = 0.0, decodeSeconds = 0.0;
+    juce::int64 numBytes = 0;
+    size_t numEvents = 0;
+    int numDone = 0, failures = 0, numMapped = 0;
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+
+    // In completion order; the output below is in file order
+    const auto results = batch.analyse(files, [&](const BatchAnalysis::FileResult& result)
+    {
+        std::cerr << "[" << ++numDone << "/" << files.size() << "] " << result.file.getFileName();
+        if (result.error.isNotEmpty()) {
+            std::cerr << ": " << result.error << std::endl;
+            failures++;
+            return;
+        }
+
+        audioSeconds += result.getDurationSeconds();
+        processingSeconds += result.decodeSeconds + result.analysisSeconds;
+        decodeSeconds += result.decodeSeconds;
+        numBytes += result.numBytes;
+        numEvents += result.events.size();
+        numMapped += result.memoryMapped ? 1 : 0;
+
+        std::cerr << std::fixed << std::setprecision(1) << " | " << result.getDurationSeconds() << " s | "
+                  << result.events.size() << " events | RTF " << std::setprecision(4) << result.getRealTimeFactor()
+                  << " | " << (result.memoryMapped ? "mapped " : "streamed ") << std::setprecision(2) << result.getIngestRate() << " GB/s" << std::endl;
+    });
+
+    if (format == "json")
+        BatchAnalysis::writeJson(out, config, results);
+    else
+        BatchAnalysis::writeCsv(out, results);
+
+    const double wallSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+    std::cerr << std::fixed << std::setprecision(2) << "BATCH: " << files.size() - failures << " files, "
+              << audioSeconds / 3600.0 << " h of audio, " << numEvents << " events in " << wallSeconds << " s on "
+              << batch.getNumThreads() << " threads | RTF " << std::setprecision(5) << (audioSeconds > 0.0 ? processingSeconds / audioSeconds : 0.0)
+              << " per thread, " << std::setprecision(0) << (wallSeconds > 0.0 ? audioSeconds / wallSeconds : 0.0) << "x real time overall"
+              << std::setprecision(2) << " | ingest " << (decodeSeconds > 0.0 ? double(numBytes) / decodeSeconds * 1.0e-9 : 0.0)
+              << " GB/s per thread (" << numMapped << " mapped), " << (wallSeconds > 0.0 ? double(numBytes) / wallSeconds * 1.0e-9 : 0.0)
+              << " GB/s overall";
+    if (failures > 0)
+        std::cerr << " | " << failures << " failed";
+    std::cerr << std::endl;
+
+    std::cout.rdbuf(stdoutBuffer);
+    return failures > 0 ? 1 : 0;
+}
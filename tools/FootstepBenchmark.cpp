@@ -0,0 +1,493 @@
+#include <juce_core/juce_core.h>
+#include <juce_audio_formats/juce_audio_formats.h>
+#include "BatchAnalysis.h"
+#include "BenchmarkTiming.h"
+#include "EmbeddedModels.h"
+#include "MFCCExtractor.h"
+#include "MLFootstepClassifier.h"
+#include "ModelRegistry.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+
+#if JUCE_MAC
+ #include <mach/mach.h>
+#endif
+
+// Benchmark harness for the detection pipeline.
+//
+// Usage: FootstepBenchmark [--section=all|startup|models|instances|hop|batch] [--models=<dir>]
+//                          [--iterations=N] [--instances=N] [--corpus=<wav or dir>]
+//                          [--threads=N] [--files=N]
+//
+// "models" section: per-model cost/latency table for every export the
+// ModelRegistry can load, plus the shared MFCC feature cost.
+//
+// "startup" section: cold and warm cost of building an instance's model
+// registry from the compiled-in models, against parsing the JSON exports.
+//
+// "instances" section: resident memory per detector instance (model registry
+// plus classifier) when N instances run in one process, as in a host with one
+// plugin per bus.
+//
+// "hop" section: fixed against adaptive inference hop on a recorded corpus
+// (every audio file in --corpus, mono downmix, detector as in the plugin with
+// the built-in weights and the Full Forest). Reports detector CPU time as a
+// share of real time, decisions analysed per second, detections per minute,
+// and, where a file has a same-named .csv of onset times in seconds, recall
+// and detection latency (detection - labelled onset) within 150 ms.
+//
+// "batch" section: thread scaling of the batch analyzer's work-stealing pool on a
+// synthetic corpus (--files WAV files of 10-60 s, written to a temporary folder),
+// from 1 thread up to --threads (default: one per core) in powers of two. Reports
+// throughput, speedup, parallel efficiency and steals, and checks that every
+// thread count finds the same events.
+namespace
+{
+    using BenchmarkTiming::TimingStats;
+    using BenchmarkTiming::measure;
+    using BenchmarkTiming::millisecondsSince;
+
+    void fillNoise(std::vector<float>& buffer, juce::Random& random, float level)
+    {
+        for (auto& sample : buffer)
+            sample = (random.nextFloat() * 2.0f - 1.0f) * level;
+    }
+
+    // Resident set size of this process, 0 where unsupported
+    size_t getResidentBytes()
+    {
+       #if JUCE_LINUX
+        juce::StringArray fields = juce::StringArray::fromTokens(juce::File("/proc/self/statm").loadFileAsString(), false);
+        return fields.size() > 1 ? static_cast<size_t>(fields[1].getLargeIntValue()) * static_cast<size_t>(getpagesize()) : 0;
+       #elif JUCE_MAC
+        mach_task_basic_info info;
+        mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+        if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS)
+            return 0;
+        return static_cast<size_t>(info.resident_size);
+       #else
+        return 0;
+       #endif
+    }
+
+    // The per-instance state a plugin instance builds: its model registry and classifier
+    struct DetectorInstance
+    {
+        ModelRegistry registry;
+        MLFootstepClassifier classifier;
+
+        DetectorInstance(const juce::File& modelDirectory, double sampleRate)
+        {
+            registry.loadDirectory(modelDirectory);
+            registry.loadDirectory(modelDirectory.getSiblingFile("models1"));
+            classifier.prepare(sampleRate, 512);
+            classifier.setModel(registry.getModel(FootstepModel::Tier::FullForest).get());
+        }
+    };
+
+    void benchmarkStartup(const juce::File& modelDirectory)
+    {
+        std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+
+        // Each case starts with nothing cached: the first instance in a fresh process
+        auto start = juce::Time::getHighResolutionTicks();
+        auto coldEmbedded = std::make_unique<ModelRegistry>();
+        int embeddedModels = EmbeddedModels::load(*coldEmbedded);
+        double coldEmbeddedMillis = millisecondsSince(start);
+
+        start = juce::Time::getHighResolutionTicks();
+        ModelRegistry warmEmbedded;
+        EmbeddedModels::load(warmEmbedded);
+        double warmEmbeddedMillis = millisecondsSince(start);
+
+        // What every instance used to do: read and parse the forest JSON
+        juce::File forestJSON = modelDirectory.getChildFile("footstep_model_cpp.json");
+        start = juce::Time::getHighResolutionTicks();
+        RandomForestModel jsonForest;
+        bool jsonLoaded = jsonForest.loadFromFile(forestJSON);
+        double jsonForestMillis = millisecondsSince(start);
+
+        start = juce::Time::getHighResolutionTicks();
+        MLFootstepClassifier classifier;
+        classifier.prepare(44100.0, 512);
+        double classifierMillis = millisecondsSince(start);
+
+        std::cout.rdbuf(coutBuffer);
+
+        std::cout << std::endl << "STARTUP" << std::endl;
+        std::cout << "   Embedded models, first instance:   " << std::fixed << std::setprecision(3) << coldEmbeddedMillis
+                  << " ms (" << embeddedModels << " models)" << std::endl;
+        std::cout << "   Embedded models, further instance: " << warmEmbeddedMillis << " ms" << std::endl;
+        if (jsonLoaded)
+            std::cout << "   Forest JSON read + parse:          " << jsonForestMillis << " ms (" << forestJSON.getFullPathName() << ")" << std::endl;
+        std::cout << "   Classifier construct + prepare:    " << classifierMillis << " ms" << std::endl;
+    }
+
+    void benchmarkInstances(const juce::File& modelDirectory, int numInstances)
+    {
+        const double sampleRate = 44100.0;
+
+        // Keep the instances' console output out of the report
+        std::vector<std::unique_ptr<DetectorInstance>> instances;
+        std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+
+        size_t before = getResidentBytes();
+        instances.push_back(std::make_unique<DetectorInstance>(modelDirectory, sampleRate));
+        size_t afterFirst = getResidentBytes();
+
+        for (int i = 1; i < numInstances; ++i)
+            instances.push_back(std::make_unique<DetectorInstance>(modelDirectory, sampleRate));
+        size_t afterAll = getResidentBytes();
+
+        std::cout.rdbuf(coutBuffer);
+
+        if (before == 0) {
+            std::cerr << "Resident memory is not available on this platform" << std::endl;
+            return;
+        }
+
+        auto kilobytes = [](double bytes) { return bytes / 1024.0; };
+        double perExtraInstance = numInstances > 1 ? static_cast<double>(afterAll - afterFirst) / (numInstances - 1) : 0.0;
+
+        std::cout << std::endl << "INSTANCE MEMORY (" << numInstances << " instances, resident)" << std::endl;
+        std::cout << "   First instance: " << std::fixed << std::setprecision(1) << kilobytes(static_cast<double>(afterFirst - before)) << " KB" << std::endl;
+        std::cout << "   Each further instance: " << kilobytes(perExtraInstance) << " KB" << std::endl;
+        std::cout << "   MFCC tables (shared): " << kilobytes(static_cast<double>(MFCCExtractor::getSharedTables(sampleRate)->getBytes())) << " KB" << std::endl;
+        std::cout << "   Models per instance: " << instances.front()->registry.getEntries().size() << std::endl;
+    }
+
+    struct CorpusFile
+    {
+        juce::String name;
+        double sampleRate = 44100.0;
+        std::vector<float> mono;
+        std::vector<juce::int64> onsets;    // samples, empty without labels
+    };
+
+    std::vector<CorpusFile> loadCorpus(const juce::File& location)
+    {
+        juce::AudioFormatManager formats;
+        formats.registerBasicFormats();
+
+        juce::Array<juce::File> files;
+        if (location.isDirectory())
+            files = location.findChildFiles(juce::File::findFiles, false, formats.getWildcardForAllFormats());
+        else
+            files.add(location);
+        files.sort();
+
+        std::vector<CorpusFile> corpus;
+        for (const auto& file : files) {
+            std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(file));
+            if (reader == nullptr)
+                continue;
+
+            juce::AudioBuffer<float> audio(static_cast<int>(reader->numChannels), static_cast<int>(reader->lengthInSamples));
+            reader->read(&audio, 0, audio.getNumSamples(), 0, true, true);
+
+            CorpusFile entry;
+            entry.name = file.getFileName();
+            entry.sampleRate = reader->sampleRate;
+            entry.mono.assign(static_cast<size_t>(audio.getNumSamples()), 0.0f);
+            for (int channel = 0; channel < audio.getNumChannels(); ++channel)
+                juce::FloatVectorOperations::addWithMultiply(entry.mono.data(), audio.getReadPointer(channel),
+                                                             1.0f / float(audio.getNumChannels()), audio.getNumSamples());
+
+            entry.onsets = BenchmarkTiming::readOnsetLabels(file.withFileExtension("csv"), entry.sampleRate);
+
+            corpus.push_back(std::move(entry));
+        }
+
+        return corpus;
+    }
+
+    void benchmarkHop(const juce::File& corpusLocation)
+    {
+        auto corpus = loadCorpus(corpusLocation);
+        if (corpus.empty()) {
+            std::cerr << "hop section needs --corpus=<audio file or directory>" << std::endl;
+            return;
+        }
+
+        ModelRegistry registry;
+        EmbeddedModels::load(registry);
+
+        double seconds = 0.0;
+        size_t labels = 0;
+        for (const auto& file : corpus) {
+            seconds += file.mono.size() / file.sampleRate;
+            labels += file.onsets.size();
+        }
+
+        std::cout << std::endl << "INFERENCE HOP (" << corpus.size() << " files, " << std::fixed << std::setprecision(1)
+                  << seconds << " s, " << labels << " labelled onsets)" << std::endl;
+        std::cout << std::left << std::setw(24) << "Detector" << std::setw(10) << "Hop" << std::right
+                  << std::setw(9) << "CPU(%)" << std::setw(12) << "Decisions/s" << std::setw(11) << "Steps/min"
+                  << std::setw(10) << "Recall" << std::setw(11) << "Mean(ms)" << std::setw(10) << "P50(ms)"
+                  << std::setw(10) << "P90(ms)" << std::endl;
+
+        for (const FootstepModel* model : { static_cast<const FootstepModel*>(nullptr), registry.getModel(FootstepModel::Tier::FullForest).get() })
+        {
+            for (bool adaptive : { false, true })
+            {
+                double cpuSeconds = 0.0;
+                long long decisions = 0;
+                int detections = 0;
+                std::vector<double> latencies;
+
+                for (const auto& file : corpus)
+                {
+                    MLFootstepClassifier::Schedule schedule;
+                    if (adaptive) {
+                        schedule.holdOffSamples = static_cast<int>(file.sampleRate * 0.2);    // the plugin's hold
+                    } else {
+                        schedule.minHop = schedule.maxHop = 64;                 // the previous fixed cadence
+                        schedule.modelMinHop = schedule.modelMaxHop = MFCCExtractor::HOP_SIZE;
+                    }
+
+                    std::vector<juce::int64> found;
+                    {
+                        std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+
+                        MLFootstepClassifier classifier;
+                        classifier.loadModel("");
+                        classifier.prepare(file.sampleRate, 512);
+                        classifier.setSchedule(schedule);
+                        classifier.setModel(model);
+
+                        const auto start = juce::Time::getHighResolutionTicks();
+                        for (size_t i = 0; i < file.mono.size(); ++i)
+                            if (classifier.detectFootstep(file.mono[i], 0.8f))
+                                found.push_back(static_cast<juce::int64>(i));
+                        cpuSeconds += millisecondsSince(start) * 0.001;
+
+                        decisions += classifier.getNumInferences();
+                        std::cout.rdbuf(coutBuffer);
+                    }
+
+                    detections += static_cast<int>(found.size());
+
+                    // First detection from the onset up to 150 ms after it
+                    const auto tolerance = static_cast<juce::int64>(file.sampleRate * 0.15);
+                    for (auto onset : file.onsets) {
+                        auto detection = std::lower_bound(found.begin(), found.end(), onset);
+                        if (detection != found.end() && *detection - onset <= tolerance)
+                            latencies.push_back(double(*detection - onset) * 1000.0 / file.sampleRate);
+                    }
+                }
+
+                std::sort(latencies.begin(), latencies.end());
+                double mean = 0.0;
+                for (double latency : latencies)
+                    mean += latency / double(latencies.size());
+                auto percentile = [&latencies](double fraction) {
+                    return latencies.empty() ? 0.0 : latencies[std::min(latencies.size() - 1, static_cast<size_t>(fraction * latencies.size()))];
+                };
+
+                std::cout << std::left << std::setw(24) << (model != nullptr ? model->getName().substring(0, 22) : juce::String("Built-in weights"))
+                          << std::setw(10) << (adaptive ? "adaptive" : "fixed") << std::right << std::fixed << std::setprecision(2)
+                          << std::setw(9) << 100.0 * cpuSeconds / seconds
+                          << std::setw(12) << std::setprecision(0) << decisions / seconds
+                          << std::setw(11) << std::setprecision(1) << detections * 60.0 / seconds;
+
+                if (labels > 0)
+                    std::cout << std::setw(6) << latencies.size() << "/" << std::left << std::setw(3) << labels << std::right
+                              << std::setw(11) << mean << std::setw(10) << percentile(0.5) << std::setw(10) << percentile(0.9);
+                std::cout << std::endl;
+            }
+        }
+    }
+
+    // The shared synthetic footsteps, 10 to 60 s per file
+    void writeSyntheticCorpus(const juce::File& folder, int numFiles)
+    {
+        const double sampleRate = 44100.0;
+        juce::Random random(4321);
+        juce::WavAudioFormat wav;
+
+        for (int index = 0; index < numFiles; ++index) {
+            const double seconds = 10.0 + random.nextDouble() * 50.0;
+            const auto audio = BenchmarkTiming::synthesizeFootsteps(sampleRate, seconds, 4321 + index);
+
+            auto file = folder.getChildFile("synthetic_" + juce::String(index).paddedLeft('0', 3) + ".wav");
+            std::unique_ptr<juce::OutputStream> stream(file.createOutputStream());
+            std::unique_ptr<juce::AudioFormatWriter> writer(wav.createWriterFor(stream.get(), sampleRate, 2, 16, {}, 0));
+            if (writer != nullptr) {
+                stream.release();    // owned by the writer now
+                writer->writeFromAudioSampleBuffer(audio, 0, audio.getNumSamples());
+            }
+        }
+    }
+
+    void benchmarkBatch(int maxThreads, int numFiles)
+    {
+        auto folder = juce::File::createTempFile("footstep_batch");
+        folder.createDirectory();
+        writeSyntheticCorpus(folder, numFiles);
+
+        auto files = folder.findChildFiles(juce::File::findFiles, false, "*.wav");
+        files.sort();
+
+        std::vector<int> threadCounts;
+        for (int threads = 1; threads < maxThreads; threads *= 2)
+            threadCounts.push_back(threads);
+        threadCounts.push_back(maxThreads);
+
+        std::cout << std::endl << "BATCH SCALING (" << files.size() << " synthetic files, " << juce::SystemStats::getNumCpus()
+                  << " cores)" << std::endl;
+        std::cout << std::right << std::setw(8) << "Threads" << std::setw(10) << "Wall(s)" << std::setw(14) << "x real time"
+                  << std::setw(10) << "Speedup" << std::setw(13) << "Efficiency" << std::setw(9) << "Steals"
+                  << std::setw(11) << "Identical" << std::endl;
+
+        std::vector<BatchAnalysis::FileResult> reference;
+        double singleThreadSeconds = 0.0;
+
+        for (int threads : threadCounts)
+        {
+            std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+
+            BatchAnalysis::Batch batch(BatchAnalysis::Config(), threads);
+            const auto start = juce::Time::getHighResolutionTicks();
+            auto results = batch.analyse(files);
+            const double wallSeconds = millisecondsSince(start) * 0.001;
+
+            std::cout.rdbuf(coutBuffer);
+
+            double audioSeconds = 0.0;
+            for (const auto& result : results)
+                audioSeconds += result.getDurationSeconds();
+
+            if (reference.empty()) {
+                reference = results;
+                singleThreadSeconds = wallSeconds;
+            }
+
+            bool identical = results.size() == reference.size();
+            for (size_t index = 0; identical && index < results.size(); ++index) {
+                const auto& a = results[index].events;
+                const auto& b = reference[index].events;
+                identical = a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](const auto& x, const auto& y) {
+                    return x.seconds == y.seconds && x.onsetSeconds == y.onsetSeconds && x.confidence == y.confidence;
+                });
+            }
+
+            const double speedup = singleThreadSeconds / wallSeconds;
+            std::cout << std::setw(8) << threads << std::fixed << std::setprecision(2) << std::setw(10) << wallSeconds
+                      << std::setw(14) << std::setprecision(0) << audioSeconds / wallSeconds
+                      << std::setw(10) << std::setprecision(2) << speedup
+                      << std::setw(12) << std::setprecision(0) << 100.0 * speedup / threads << "%"
+                      << std::setw(9) << batch.getNumSteals() << std::setw(11) << (identical ? "yes" : "NO") << std::endl;
+        }
+
+        folder.deleteRecursively();
+    }
+
+    void benchmarkModels(const juce::File& modelDirectory, int iterations)
+    {
+        // Registry models decide once per MFCC hop at 44.1 kHz
+        const double decisionsPerSecond = 44100.0 / MFCCExtractor::HOP_SIZE;
+
+        ModelRegistry registry;
+        registry.loadDirectory(modelDirectory);
+        registry.loadDirectory(modelDirectory.getSiblingFile("models1"));
+
+        if (registry.isEmpty()) {
+            std::cerr << "No models found in " << modelDirectory.getFullPathName() << std::endl;
+            return;
+        }
+
+        juce::Random random(1234);
+        std::vector<float> window(MFCCExtractor::WINDOW_SIZE);
+        fillNoise(window, random, 0.2f);
+
+        MFCCExtractor extractor;
+        extractor.prepare(44100.0);
+
+        std::array<float, MFCCExtractor::N_FEATURES> features{};
+        TimingStats mfcc = measure([&] { features = extractor.extractFeatures(window.data(), MFCCExtractor::WINDOW_SIZE); },
+                                   std::max(1, iterations / 100));
+
+        // A spread of feature vectors so tree paths vary between runs
+        std::vector<std::array<float, MFCCExtractor::N_FEATURES>> featureSets(64);
+        for (auto& set : featureSets) {
+            fillNoise(window, random, 0.05f + random.nextFloat() * 0.5f);
+            set = extractor.extractFeatures(window.data(), MFCCExtractor::WINDOW_SIZE);
+        }
+
+        std::cout << std::endl << "MODEL COST TABLE (" << iterations << " iterations)" << std::endl;
+        std::cout << "   MFCC features: mean " << std::fixed << std::setprecision(2) << mfcc.meanMicros
+                  << " us | p99 " << mfcc.p99Micros << " us (shared by every model)" << std::endl << std::endl;
+
+        std::cout << std::left << std::setw(52) << "Model" << std::right
+                  << std::setw(7) << "Ops" << std::setw(9) << "Bytes"
+                  << std::setw(11) << "Mean(us)" << std::setw(11) << "P99(us)"
+                  << std::setw(14) << "+MFCC(us)" << std::setw(10) << "CPU(%)" << std::endl;
+
+        for (const auto& entry : registry.getEntries()) {
+            size_t index = 0;
+            volatile float sink = 0.0f;
+            TimingStats inference = measure([&] {
+                sink = sink + entry.model->predictProbability(featureSets[index++ % featureSets.size()].data());
+            }, std::max(10, iterations / 100), 100);
+
+            double perDecision = inference.meanMicros + mfcc.meanMicros;
+            double cpuPercent = perDecision * decisionsPerSecond / 1.0e4;
+
+            std::cout << std::left << std::setw(52) << entry.model->getName().toStdString() << std::right
+                      << std::setw(7) << entry.model->getOperationsPerInference()
+                      << std::setw(9) << entry.model->getModelBytes()
+                      << std::setw(11) << std::setprecision(3) << inference.meanMicros
+                      << std::setw(11) << inference.p99Micros
+                      << std::setw(14) << std::setprecision(2) << perDecision
+                      << std::setw(10) << cpuPercent << std::endl;
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ArgumentList args(argc, argv);
+
+    juce::File modelDirectory = juce::File::getCurrentWorkingDirectory().getChildFile("models");
+    if (args.containsOption("--models"))
+        modelDirectory = juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--models"));
+
+    int iterations = 20000;
+    if (args.containsOption("--iterations"))
+        iterations = std::max(10, args.getValueForOption("--iterations").getIntValue());
+
+    int numInstances = 32;
+    if (args.containsOption("--instances"))
+        numInstances = std::max(1, args.getValueForOption("--instances").getIntValue());
+
+    int maxThreads = juce::SystemStats::getNumCpus();
+    if (args.containsOption("--threads"))
+        maxThreads = std::max(1, args.getValueForOption("--threads").getIntValue());
+
+    int numFiles = 64;
+    if (args.containsOption("--files"))
+        numFiles = std::max(1, args.getValueForOption("--files").getIntValue());
+
+    juce::String section = args.containsOption("--section") ? args.getValueForOption("--section") : juce::String("all");
+
+    // Startup first, while nothing is cached yet
+    if (section == "all" || section == "startup")
+        benchmarkStartup(modelDirectory);
+
+    // Instances next, while the process is still small and resident memory is easy to attribute
+    if (section == "all" || section == "instances")
+        benchmarkInstances(modelDirectory, numInstances);
+
+    if (section == "all" || section == "models")
+        benchmarkModels(modelDirectory, iterations);
+
+    if (section == "hop" || (section == "all" && args.containsOption("--corpus")))
+        benchmarkHop(juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--corpus")));
+
+    if (section == "all" || section == "batch")
+        benchmarkBatch(maxThreads, numFiles);
+
+    return 0;
+}
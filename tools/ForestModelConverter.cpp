@@ -0,0 +1,100 @@
+#include <juce_core/juce_core.h>
+#include "RandomForestModel.h"
+#include <iostream>
+#include <iomanip>
+
+// Converts a forest JSON export (footstep_model_cpp.json) into the binary
+// model format the plugin memory-maps, then checks the result: load time of
+// both formats and prediction equality on random feature vectors.
+//
+// Usage: ForestModelConverter <model.json> [output.fsm] [--checks=N]
+//
+// Pickled sklearn models (.pkl) are exported to JSON by the training notebook first.
+
+namespace
+{
+    double millisecondsSince(juce::int64 startTicks)
+    {
+        return juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) * 1000.0;
+    }
+
+    // Random raw features spread around the scaler means so every split is exercised
+    void fillFeatures(float* features, const RandomForestModel& forest, juce::Random& random)
+    {
+        for (int i = 0; i < FootstepModel::N_FEATURES; ++i) {
+            float sigma = (random.nextFloat() * 2.0f - 1.0f) * 4.0f;
+            features[i] = forest.getScalerMeans()[i] + sigma * forest.getScalerStds()[i];
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ArgumentList args(argc, argv);
+
+    if (args.size() < 1 || args[0].isLongOption()) {
+        std::cout << "Usage: ForestModelConverter <model.json> [output.fsm] [--checks=N]" << std::endl;
+        return 1;
+    }
+
+    juce::File jsonFile = args[0].resolveAsFile();
+    juce::File binaryFile = jsonFile.withFileExtension(".fsm");
+    if (args.size() > 1 && !args[1].isLongOption())
+        binaryFile = args[1].resolveAsFile();
+
+    int checks = 10000;
+    if (args.containsOption("--checks"))
+        checks = std::max(1, args.getValueForOption("--checks").getIntValue());
+
+    auto start = juce::Time::getHighResolutionTicks();
+    RandomForestModel jsonForest;
+    if (!jsonForest.loadFromFile(jsonFile)) {
+        std::cerr << "Failed to load forest model: " << jsonFile.getFullPathName() << std::endl;
+        return 1;
+    }
+    double jsonMillis = millisecondsSince(start);
+
+    binaryFile.deleteFile();
+    {
+        juce::FileOutputStream output(binaryFile);
+        if (!output.openedOk() || !jsonForest.writeBinary(output)) {
+            std::cerr << "Failed to write binary model: " << binaryFile.getFullPathName() << std::endl;
+            return 1;
+        }
+    }
+
+    start = juce::Time::getHighResolutionTicks();
+    RandomForestModel binaryForest;
+    if (!binaryForest.loadFromBinaryFile(binaryFile)) {
+        std::cerr << "Failed to map the written binary model" << std::endl;
+        return 1;
+    }
+    double binaryMillis = millisecondsSince(start);
+
+    // Both formats must give bit-identical probabilities in both modes
+    juce::Random random(42);
+    std::array<float, FootstepModel::N_FEATURES> features{};
+    int mismatches = 0;
+
+    for (int i = 0; i < checks; ++i) {
+        fillFeatures(features.data(), jsonForest, random);
+
+        for (bool quantized : { false, true }) {
+            jsonForest.setQuantizedMode(quantized);
+            binaryForest.setQuantizedMode(quantized);
+            if (jsonForest.predictProbability(features.data()) != binaryForest.predictProbability(features.data()))
+                mismatches++;
+        }
+    }
+
+    std::cout << std::endl << "FOREST MODEL CONVERSION" << std::endl;
+    std::cout << "   " << jsonFile.getFileName() << ": " << jsonFile.getSize() << " bytes, loaded in "
+              << std::fixed << std::setprecision(3) << jsonMillis << " ms" << std::endl;
+    std::cout << "   " << binaryFile.getFileName() << ": " << binaryFile.getSize() << " bytes, mapped in "
+              << binaryMillis << " ms (checksum verified)" << std::endl;
+    std::cout << "   Trees: " << binaryForest.getNumTrees() << " | Nodes: " << binaryForest.getNumNodes()
+              << " | Format version: " << RandomForestModel::BINARY_VERSION << std::endl;
+    std::cout << "   Prediction checks: " << checks * 2 << " | mismatches: " << mismatches << std::endl;
+
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,149 @@
+#include <juce_core/juce_core.h>
+#include <juce_audio_formats/juce_audio_formats.h>
+#include "MFCCExtractor.h"
+#include "RandomForestModel.h"
+#include <iostream>
+#include <iomanip>
+
+// Accuracy-equivalence report: runs the float and int16 forests side by side
+// on MFCC windows from recorded audio and reports where they disagree.
+//
+// Usage: ForestQuantizationReport <model.json> <audio files...> [--threshold=0.5]
+
+namespace
+{
+    struct ComparisonStats
+    {
+        int windows = 0;
+        int decisionMismatches = 0;
+        int floatPositives = 0;
+        int quantizedPositives = 0;
+        double sumAbsDiff = 0.0;
+        float maxAbsDiff = 0.0f;
+
+        void add(const ComparisonStats& other)
+        {
+            windows += other.windows;
+            decisionMismatches += other.decisionMismatches;
+            floatPositives += other.floatPositives;
+            quantizedPositives += other.quantizedPositives;
+            sumAbsDiff += other.sumAbsDiff;
+            maxAbsDiff = std::max(maxAbsDiff, other.maxAbsDiff);
+        }
+    };
+
+    void printRow(const juce::String& name, const ComparisonStats& stats)
+    {
+        double agreement = stats.windows > 0 ? 100.0 * (stats.windows - stats.decisionMismatches) / stats.windows : 100.0;
+        double meanDiff = stats.windows > 0 ? stats.sumAbsDiff / stats.windows : 0.0;
+
+        std::cout << std::left << std::setw(32) << name.substring(0, 31).toStdString() << std::right
+                  << std::setw(9) << stats.windows
+                  << std::setw(10) << stats.floatPositives
+                  << std::setw(10) << stats.quantizedPositives
+                  << std::setw(11) << std::fixed << std::setprecision(3) << agreement << "%"
+                  << std::setw(12) << std::setprecision(6) << meanDiff
+                  << std::setw(12) << stats.maxAbsDiff << std::endl;
+    }
+
+    ComparisonStats compareFile(const juce::File& file, juce::AudioFormatManager& formats,
+                                const RandomForestModel& forest, float threshold)
+    {
+        ComparisonStats stats;
+        std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(file));
+
+        if (reader == nullptr) {
+            std::cerr << "Cannot read audio file: " << file.getFullPathName() << std::endl;
+            return stats;
+        }
+
+        const int numSamples = static_cast<int>(reader->lengthInSamples);
+        const int numChannels = static_cast<int>(reader->numChannels);
+        juce::AudioBuffer<float> audio(numChannels, numSamples);
+        reader->read(&audio, 0, numSamples, 0, true, true);
+
+        // Mono downmix, matching what the detector sees
+        std::vector<float> mono(static_cast<size_t>(numSamples), 0.0f);
+        for (int ch = 0; ch < numChannels; ++ch)
+            juce::FloatVectorOperations::addWithMultiply(mono.data(), audio.getReadPointer(ch), 1.0f / numChannels, numSamples);
+
+        MFCCExtractor extractor;
+        extractor.prepare(reader->sampleRate);
+
+        RandomForestModel::QuantizedFeatureVector quantized;
+
+        for (int start = 0; start + MFCCExtractor::WINDOW_SIZE <= numSamples; start += MFCCExtractor::HOP_SIZE) {
+            auto features = extractor.extractFeatures(mono.data() + start, MFCCExtractor::WINDOW_SIZE);
+
+            float floatProbability = forest.predict(features.data());
+            forest.quantizeFeatures(features.data(), quantized.data());
+            float quantizedProbability = forest.predictQuantized(quantized.data());
+
+            bool floatDecision = floatProbability > threshold;
+            bool quantizedDecision = quantizedProbability > threshold;
+            float diff = std::abs(floatProbability - quantizedProbability);
+
+            stats.windows++;
+            stats.floatPositives += floatDecision ? 1 : 0;
+            stats.quantizedPositives += quantizedDecision ? 1 : 0;
+            stats.decisionMismatches += floatDecision != quantizedDecision ? 1 : 0;
+            stats.sumAbsDiff += diff;
+            stats.maxAbsDiff = std::max(stats.maxAbsDiff, diff);
+        }
+
+        return stats;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ArgumentList args(argc, argv);
+
+    if (args.size() < 2) {
+        std::cout << "Usage: ForestQuantizationReport <model.json> <audio files...> [--threshold=0.5]" << std::endl;
+        return 1;
+    }
+
+    float threshold = 0.5f;
+    if (args.containsOption("--threshold"))
+        threshold = args.getValueForOption("--threshold").getFloatValue();
+
+    RandomForestModel forest;
+    if (!forest.loadFromFile(args[0].resolveAsFile())) {
+        std::cerr << "Failed to load forest model: " << args[0].text << std::endl;
+        return 1;
+    }
+
+    if (!forest.hasQuantizedNodes()) {
+        std::cerr << "Forest has trees too large for the int16 mode: " << args[0].text << std::endl;
+        return 1;
+    }
+
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+
+    std::cout << std::endl << "FOREST QUANTIZATION REPORT" << std::endl;
+    std::cout << "   Trees: " << forest.getNumTrees() << " | Nodes: " << forest.getNumNodes() << std::endl;
+    std::cout << "   Float model: " << forest.getFloatModelBytes() << " bytes | int16 model: "
+              << forest.getQuantizedModelBytes() << " bytes" << std::endl;
+    std::cout << "   Decision threshold: " << threshold << std::endl << std::endl;
+
+    std::cout << std::left << std::setw(32) << "File" << std::right
+              << std::setw(9) << "Windows" << std::setw(10) << "FloatPos" << std::setw(10) << "Int16Pos"
+              << std::setw(12) << "Agreement" << std::setw(12) << "MeanAbsDP" << std::setw(12) << "MaxAbsDP" << std::endl;
+
+    ComparisonStats total;
+
+    for (int i = 1; i < args.size(); ++i) {
+        if (args[i].isLongOption())
+            continue;
+
+        juce::File file = args[i].resolveAsFile();
+        ComparisonStats stats = compareFile(file, formats, forest, threshold);
+        printRow(file.getFileName(), stats);
+        total.add(stats);
+    }
+
+    printRow("TOTAL", total);
+    return 0;
+}
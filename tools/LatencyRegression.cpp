@@ -0,0 +1,395 @@
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_audio_formats/juce_audio_formats.h>
+#include "BenchmarkTiming.h"
+#include "PluginProcessor.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <tuple>
+
+// Per-callback processBlock timing with host-like block sizes, checked against a
+// stored baseline. Average CPU hides glitches; this guards the tail.
+//
+// Usage: LatencyRegression [--input=<audio file>] [--seconds=N] [--sample-rate=R] [--max-block=N]
+//                          [--runs=N] [--warmup=S] [--seed=N] [--tier=N] [--background] [--cpu-guard]
+//                          [--output=<report.json>] [--baseline=<report.json>]
+//                          [--tolerance=F] [--slack=US]
+//
+// The processor is prepared for --max-block (default 512) at the input's rate, or
+// at --sample-rate (default 48 kHz) for the synthetic input: --seconds (default 30)
+// of noise with footstep-like thumps. Recorded input is played in stereo (mono is
+// doubled, further channels dropped), --seconds of it if given.
+//
+// Callbacks follow a seeded host-like schedule: mostly full blocks, some a little
+// short (drifting device clocks), some split in two (loop points, automation) and
+// now and then a handful of samples. Each of --runs (default 3) plays the input once
+// through a fresh processor; callbacks in the first --warmup seconds (default 0.5)
+// are not counted. The percentiles reported (p50, p99, p99.9, max, in microseconds,
+// plus the largest fraction of a callback's real-time budget) are the medians over
+// the runs; the histogram covers every counted callback of every run.
+//
+// Plugin defaults apply except: the --tier model, background analysis only with
+// --background, and the CPU guard only with --cpu-guard (it would otherwise hide
+// a regression by degrading the detector).
+//
+// --output writes the report as JSON; a stored report is the --baseline of later
+// runs. With a baseline, the run fails (exit code 1) when p99 or p99.9 exceeds the
+// baseline's by more than --tolerance (default 0.25, i.e. 25 %) plus --slack
+// microseconds (default 2, for timer resolution), or when the configurations differ.
+
+namespace
+{
+    struct Options
+    {
+        juce::File input;
+        double seconds = 0.0;
+        double sampleRate = 48000.0;
+        int maxBlock = 512;
+        int runs = 3;
+        double warmupSeconds = 0.5;
+        int seed = 1;
+        int tier = 0;
+        bool background = false;
+        bool cpuGuard = false;
+    };
+
+    struct Percentiles
+    {
+        double p50 = 0.0;
+        double p99 = 0.0;
+        double p999 = 0.0;
+        double max = 0.0;
+        double maxLoad = 0.0;       // callback time over its real-time length
+    };
+
+    using BenchmarkTiming::ScopedSilence;
+    using BenchmarkTiming::setParameter;
+
+    bool loadInput(const Options& options, juce::AudioBuffer<float>& audio, double& sampleRate)
+    {
+        juce::AudioFormatManager formats;
+        formats.registerBasicFormats();
+
+        std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(options.input));
+        if (reader == nullptr || reader->lengthInSamples <= 0)
+            return false;
+
+        sampleRate = reader->sampleRate;
+        juce::int64 length = reader->lengthInSamples;
+        if (options.seconds > 0.0)
+            length = std::min<juce::int64>(length, static_cast<juce::int64>(options.seconds * sampleRate));
+
+        audio.setSize(2, static_cast<int>(length));
+        reader->read(&audio, 0, audio.getNumSamples(), 0, true, true);
+
+        if (reader->numChannels == 1)
+            audio.copyFrom(1, 0, audio, 0, 0, audio.getNumSamples());
+        return true;
+    }
+
+    void makeSyntheticInput(const Options& options, juce::AudioBuffer<float>& audio)
+    {
+        audio = BenchmarkTiming::synthesizeFootsteps(options.sampleRate, options.seconds > 0.0 ? options.seconds : 30.0, 4242);
+    }
+
+    // Host-like callback sizes over the whole input, never above maxBlock
+    std::vector<int> makeSchedule(int numSamples, int maxBlock, int seed)
+    {
+        juce::Random random(seed);
+        std::vector<int> schedule;
+
+        for (int position = 0; position < numSamples;)
+        {
+            const int roll = random.nextInt(100);
+            std::vector<int> sizes;
+
+            if (roll < 70) {
+                sizes = { maxBlock };
+            } else if (roll < 85) {
+                sizes = { maxBlock - random.nextInt(juce::jmax(1, maxBlock / 8)) };
+            } else if (roll < 95) {
+                const int split = 1 + random.nextInt(juce::jmax(1, maxBlock - 1));
+                sizes = { split, maxBlock - split };
+            } else {
+                sizes = { 1 + random.nextInt(juce::jmin(16, maxBlock)) };
+            }
+
+            for (int size : sizes) {
+                size = juce::jmin(size, numSamples - position);
+                if (size <= 0)
+                    continue;
+                schedule.push_back(size);
+                position += size;
+            }
+        }
+
+        return schedule;
+    }
+
+    double percentile(const std::vector<double>& sorted, double fraction)
+    {
+        return sorted[std::min(sorted.size() - 1, static_cast<size_t>(double(sorted.size()) * fraction))];
+    }
+
+    // One pass of the input through a fresh processor; returns the counted callback
+    // times in microseconds and their loads
+    void runOnce(const Options& options, const juce::AudioBuffer<float>& input, double sampleRate, const std::vector<int>& schedule,
+                 std::vector<double>& micros, std::vector<double>& loads)
+    {
+        ScopedSilence silence;
+
+        FootstepDetectorAudioProcessor processor;
+        setParameter(processor, "modelTier", static_cast<float>(options.tier));
+        setParameter(processor, "backgroundAnalysis", options.background ? 1.0f : 0.0f);
+        setParameter(processor, "cpuGuard", options.cpuGuard ? 1.0f : 0.0f);
+
+        processor.setRateAndBufferSizeDetails(sampleRate, options.maxBlock);
+        processor.prepareToPlay(sampleRate, options.maxBlock);
+
+        juce::AudioBuffer<float> buffer(2, options.maxBlock);
+        juce::MidiBuffer midi;
+        const int warmupSamples = static_cast<int>(options.warmupSeconds * sampleRate);
+
+        juce::ScopedNoDenormals noDenormals;
+        int position = 0;
+
+        for (int numSamples : schedule)
+        {
+            // Hosts hand over a buffer sized for the callback
+            buffer.setSize(2, numSamples, false, false, true);
+            for (int channel = 0; channel < 2; ++channel)
+                buffer.copyFrom(channel, 0, input, channel, position, numSamples);
+
+            const auto startTicks = juce::Time::getHighResolutionTicks();
+            processor.processBlock(buffer, midi);
+            const double elapsed = BenchmarkTiming::millisecondsSince(startTicks) * 1000.0;
+
+            if (position >= warmupSamples) {
+                micros.push_back(elapsed);
+                loads.push_back(elapsed / (1.0e6 * numSamples / sampleRate));
+            }
+            position += numSamples;
+        }
+
+        processor.releaseResources();
+    }
+
+    Percentiles getPercentiles(std::vector<double> micros, const std::vector<double>& loads)
+    {
+        std::sort(micros.begin(), micros.end());
+
+        Percentiles result;
+        result.p50 = percentile(micros, 0.5);
+        result.p99 = percentile(micros, 0.99);
+        result.p999 = percentile(micros, 0.999);
+        result.max = micros.back();
+        result.maxLoad = *std::max_element(loads.begin(), loads.end());
+        return result;
+    }
+
+    double median(std::vector<double> values)
+    {
+        std::sort(values.begin(), values.end());
+        return values[values.size() / 2];
+    }
+
+    juce::var toVar(const Percentiles& percentiles)
+    {
+        auto* object = new juce::DynamicObject();
+        object->setProperty("p50_us", percentiles.p50);
+        object->setProperty("p99_us", percentiles.p99);
+        object->setProperty("p999_us", percentiles.p999);
+        object->setProperty("max_us", percentiles.max);
+        object->setProperty("max_load", percentiles.maxLoad);
+        return juce::var(object);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList args(argc, argv);
+
+    Options options;
+    if (args.containsOption("--input"))
+        options.input = juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--input"));
+    if (args.containsOption("--seconds"))
+        options.seconds = args.getValueForOption("--seconds").getDoubleValue();
+    if (args.containsOption("--sample-rate"))
+        options.sampleRate = juce::jmax(8000.0, args.getValueForOption("--sample-rate").getDoubleValue());
+    if (args.containsOption("--max-block"))
+        options.maxBlock = juce::jlimit(16, 8192, args.getValueForOption("--max-block").getIntValue());
+    if (args.containsOption("--runs"))
+        options.runs = juce::jmax(1, args.getValueForOption("--runs").getIntValue());
+    if (args.containsOption("--warmup"))
+        options.warmupSeconds = juce::jmax(0.0, args.getValueForOption("--warmup").getDoubleValue());
+    if (args.containsOption("--seed"))
+        options.seed = args.getValueForOption("--seed").getIntValue();
+    if (args.containsOption("--tier"))
+        options.tier = juce::jlimit(0, FootstepModel::NUM_TIERS, args.getValueForOption("--tier").getIntValue());
+    options.background = args.containsOption("--background");
+    options.cpuGuard = args.containsOption("--cpu-guard");
+
+    const double tolerance = args.containsOption("--tolerance") ? juce::jmax(0.0, args.getValueForOption("--tolerance").getDoubleValue()) : 0.25;
+    const double slack = args.containsOption("--slack") ? juce::jmax(0.0, args.getValueForOption("--slack").getDoubleValue()) : 2.0;
+
+    juce::AudioBuffer<float> input;
+    double sampleRate = options.sampleRate;
+    juce::String inputName = "synthetic";
+
+    if (options.input != juce::File()) {
+        if (!loadInput(options, input, sampleRate)) {
+            std::cerr << "Cannot read " << options.input.getFullPathName() << std::endl;
+            return 1;
+        }
+        inputName = options.input.getFileName();
+    } else {
+        makeSyntheticInput(options, input);
+    }
+
+    const auto schedule = makeSchedule(input.getNumSamples(), options.maxBlock, options.seed);
+
+    std::vector<Percentiles> runs;
+    std::vector<double> allMicros;
+    for (int run = 0; run < options.runs; ++run) {
+        std::vector<double> micros, loads;
+        runOnce(options, input, sampleRate, schedule, micros, loads);
+
+        if (micros.empty()) {
+            std::cerr << "No callbacks after the warm-up; use a longer input or a shorter --warmup" << std::endl;
+            return 1;
+        }
+
+        runs.push_back(getPercentiles(micros, loads));
+        allMicros.insert(allMicros.end(), micros.begin(), micros.end());
+    }
+
+    auto medianOf = [&runs](double Percentiles::*field) {
+        std::vector<double> values;
+        for (const auto& run : runs)
+            values.push_back(run.*field);
+        return median(values);
+    };
+
+    Percentiles result;
+    result.p50 = medianOf(&Percentiles::p50);
+    result.p99 = medianOf(&Percentiles::p99);
+    result.p999 = medianOf(&Percentiles::p999);
+    result.max = medianOf(&Percentiles::max);
+    result.maxLoad = medianOf(&Percentiles::maxLoad);
+
+    // Octave buckets from 1 us: [0, 1), [1, 2), [2, 4), ...
+    std::vector<int> histogram(1, 0);
+    for (double micros : allMicros) {
+        size_t bucket = micros < 1.0 ? 0 : static_cast<size_t>(std::floor(std::log2(micros))) + 1;
+        if (bucket >= histogram.size())
+            histogram.resize(bucket + 1, 0);
+        histogram[bucket]++;
+    }
+
+    auto bucketLower = [](size_t bucket) { return bucket == 0 ? 0.0 : std::pow(2.0, double(bucket) - 1.0); };
+    auto bucketUpper = [](size_t bucket) { return std::pow(2.0, double(bucket)); };
+
+    int shortest = options.maxBlock, longest = 0;
+    for (int size : schedule) {
+        shortest = juce::jmin(shortest, size);
+        longest = juce::jmax(longest, size);
+    }
+
+    std::cout << "PROCESSBLOCK LATENCY (" << inputName << ", " << input.getNumSamples() / sampleRate << " s at " << sampleRate
+              << " Hz, " << schedule.size() << " callbacks of " << shortest << "-" << longest << " samples, tier " << options.tier
+              << (options.background ? ", background" : ", inline") << (options.cpuGuard ? ", CPU guard" : "")
+              << ", " << options.runs << " runs)" << std::endl;
+    std::cout << std::fixed << std::setprecision(1) << "p50 " << result.p50 << " us | p99 " << result.p99 << " us | p99.9 "
+              << result.p999 << " us | max " << result.max << " us | max load " << std::setprecision(1) << 100.0 * result.maxLoad
+              << "% of a callback" << std::endl << std::endl;
+
+    for (size_t bucket = 0; bucket < histogram.size(); ++bucket) {
+        const double share = double(histogram[bucket]) / double(allMicros.size());
+        std::cout << std::right << std::setw(8) << std::setprecision(0) << bucketLower(bucket) << " - " << std::left << std::setw(8)
+                  << bucketUpper(bucket) << std::right << std::setw(9) << histogram[bucket] << std::setw(8) << std::setprecision(2)
+                  << 100.0 * share << "% " << juce::String::repeatedString("#", juce::roundToInt(share * 50.0)) << std::endl;
+    }
+
+    // Report, also the baseline format
+    auto* config = new juce::DynamicObject();
+    config->setProperty("input", inputName);
+    config->setProperty("sample_rate", sampleRate);
+    config->setProperty("num_samples", input.getNumSamples());
+    config->setProperty("max_block", options.maxBlock);
+    config->setProperty("seed", options.seed);
+    config->setProperty("warmup_s", options.warmupSeconds);
+    config->setProperty("tier", options.tier);
+    config->setProperty("background", options.background);
+    config->setProperty("cpu_guard", options.cpuGuard);
+
+    juce::Array<juce::var> buckets;
+    for (size_t bucket = 0; bucket < histogram.size(); ++bucket) {
+        auto* object = new juce::DynamicObject();
+        object->setProperty("lower_us", bucketLower(bucket));
+        object->setProperty("upper_us", bucketUpper(bucket));
+        object->setProperty("count", histogram[bucket]);
+        buckets.add(juce::var(object));
+    }
+
+    juce::Array<juce::var> runResults;
+    for (const auto& run : runs)
+        runResults.add(toVar(run));
+
+    auto* root = new juce::DynamicObject();
+    root->setProperty("cpu", juce::SystemStats::getCpuModel());
+    root->setProperty("time", juce::Time::getCurrentTime().toISO8601(true));
+    root->setProperty("config", juce::var(config));
+    root->setProperty("result", toVar(result));
+    root->setProperty("runs", runResults);
+    root->setProperty("histogram", buckets);
+    const juce::var report(root);
+
+    if (args.containsOption("--output")) {
+        std::ofstream output(juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--output")).getFullPathName().toStdString());
+        if (!output) {
+            std::cerr << "Cannot write " << args.getValueForOption("--output") << std::endl;
+            return 1;
+        }
+        output << juce::JSON::toString(report) << std::endl;
+    }
+
+    if (!args.containsOption("--baseline"))
+        return 0;
+
+    const auto baselineFile = juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--baseline"));
+    const auto baseline = juce::JSON::parse(baselineFile);
+    if (!baseline.isObject()) {
+        std::cerr << "Cannot read the baseline " << baselineFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    // Only like for like: same input, schedule and processor setup
+    for (const char* key : { "input", "sample_rate", "num_samples", "max_block", "seed", "warmup_s", "tier", "background", "cpu_guard" }) {
+        if (baseline["config"][key].toString() != report["config"][key].toString()) {
+            std::cout << std::endl << "BASELINE MISMATCH: " << key << " is " << report["config"][key].toString()
+                      << ", the baseline's " << baseline["config"][key].toString() << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << std::endl << "BASELINE " << baselineFile.getFileName() << " (tolerance " << std::setprecision(0) << 100.0 * tolerance
+              << "% + " << std::setprecision(1) << slack << " us)" << std::endl;
+
+    bool regressed = false;
+    for (const auto& [name, key, value] : { std::make_tuple("p99", "p99_us", result.p99), std::make_tuple("p99.9", "p999_us", result.p999) }) {
+        const double reference = static_cast<double>(baseline["result"][key]);
+        const double limit = reference * (1.0 + tolerance) + slack;
+        const bool failed = value > limit;
+        regressed = regressed || failed;
+
+        std::cout << std::left << std::setw(7) << name << std::right << std::setw(10) << value << " us  baseline" << std::setw(10)
+                  << reference << " us  limit" << std::setw(10) << limit << " us  " << (failed ? "FAIL" : "ok") << std::endl;
+    }
+
+    if (regressed)
+        std::cout << "LATENCY REGRESSION: the processBlock tail is past the baseline" << std::endl;
+    return regressed ? 1 : 0;
+}
@@ -0,0 +1,205 @@
+#include "MappedAudio.h"
+#include <cstring>
+
+namespace
+{
+    // MemoryMappedAudioFormatReader reads only per frame (getSample) or into int
+    // buffers; where a sample sits in the mapped pages is protected, and taken
+    // here through a member pointer
+    struct MappedFrames : juce::MemoryMappedAudioFormatReader
+    {
+        static const char* get(const juce::MemoryMappedAudioFormatReader& reader, juce::int64 sample)
+        {
+            return static_cast<const char*>((reader.*&MappedFrames::sampleToPointer)(sample));
+        }
+    };
+
+    // AIFC 'sowt' files hold little-endian samples; AIFF and every other AIFC type are big-endian
+    bool isLittleEndianAiff(const juce::File& file)
+    {
+        juce::FileInputStream in(file);
+        char id[4] = {};
+
+        if (!in.openedOk() || in.read(id, 4) != 4 || std::memcmp(id, "FORM", 4) != 0)
+            return false;
+        in.readIntBigEndian();
+        if (in.read(id, 4) != 4 || std::memcmp(id, "AIFC", 4) != 0)
+            return false;
+
+        while (in.read(id, 4) == 4) {
+            const juce::int64 size = static_cast<juce::uint32>(in.readIntBigEndian());
+            const juce::int64 next = in.getPosition() + size + (size & 1);
+
+            // COMM: channels (2), frames (4), bits (2), rate (10), then the compression type
+            if (std::memcmp(id, "COMM", 4) == 0)
+                return size >= 22 && in.setPosition(in.getPosition() + 18) && in.read(id, 4) == 4 && std::memcmp(id, "sowt", 4) == 0;
+
+            if (!in.setPosition(next))
+                break;
+        }
+
+        return false;
+    }
+
+    // Conversions as juce::AudioData makes them: to a left-aligned int32, then scaled
+    // by 1 / 0x7fffffff as AudioFormatReader::read does
+    inline float fixedToFloat(juce::uint32 leftAligned)
+    {
+        constexpr auto scale = 1.0f / static_cast<float>(0x7fffffff);
+        return static_cast<float>(static_cast<juce::int32>(leftAligned)) * scale;
+    }
+
+    // Non-finite samples become zero, as SampleSanitizer::replaceNonFinite makes them
+    inline float floatBits(juce::uint32 bits)
+    {
+        if ((bits & 0x7f800000u) == 0x7f800000u)
+            return 0.0f;
+
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    // The downmix loop, with the sample conversion inlined
+    template <typename Load>
+    void mixFrames(const char* frames, int bytesPerFrame, const std::vector<int>& offsets, float* destination, int numSamples, Load load)
+    {
+        const size_t numMixed = offsets.size();
+        const float gain = 1.0f / float(numMixed);
+
+        for (int i = 0; i < numSamples; ++i, frames += bytesPerFrame) {
+            float sum = load(frames + offsets[0]);
+            for (size_t channel = 1; channel < numMixed; ++channel)
+                sum += load(frames + offsets[channel]);
+
+            destination[i] = numMixed > 1 ? sum * gain : sum;
+        }
+    }
+}
+
+MappedAudio::MappedAudio() = default;
+
+MappedAudio::~MappedAudio() = default;
+
+bool MappedAudio::open(const juce::File& file, juce::AudioFormatManager& formats)
+{
+    close();
+
+    // Only formats with uncompressed data return a mapped reader (WAV, AIFF)
+    for (int index = 0; index < formats.getNumKnownFormats() && reader == nullptr; ++index) {
+        auto* format = formats.getKnownFormat(index);
+        if (format->canHandleFile(file))
+            reader.reset(format->createMemoryMappedReader(file));
+    }
+
+    if (reader == nullptr)
+        return false;
+
+    const bool wav = reader->getFormatName() == "WAV file";
+    littleEndian = wav || isLittleEndianAiff(file);
+    bytesPerSample = static_cast<int>(reader->bitsPerSample / 8);
+    bytesPerFrame = bytesPerSample * static_cast<int>(reader->numChannels);
+
+    if (reader->usesFloatingPointData) {
+        if (reader->bitsPerSample != 32) {
+            close();
+            return false;
+        }
+        encoding = Encoding::float32;
+        return true;
+    }
+
+    switch (reader->bitsPerSample)
+    {
+        case 8:  encoding = wav ? Encoding::unsigned8 : Encoding::signed8; return true;
+        case 16: encoding = Encoding::int16; return true;
+        case 24: encoding = Encoding::int24; return true;
+        case 32: encoding = Encoding::int32; return true;
+        default: close(); return false;
+    }
+}
+
+void MappedAudio::close()
+{
+    reader.reset();
+}
+
+bool MappedAudio::map(juce::int64 start, juce::int64 end)
+{
+    const juce::Range<juce::int64> samples(start, end);
+    return reader != nullptr && reader->mapSectionOfFile(samples) && reader->getMappedSection().contains(samples);
+}
+
+void MappedAudio::downmix(juce::int64 position, int numSamples, const std::vector<int>& channels, float* destination)
+{
+    offsets.clear();
+    for (int channel : channels)
+        if (channel < static_cast<int>(reader->numChannels))
+            offsets.push_back(channel * bytesPerSample);
+
+    if (offsets.empty()) {
+        juce::FloatVectorOperations::clear(destination, numSamples);
+        return;
+    }
+
+    const char* frames = MappedFrames::get(*reader, position);
+
+    switch (encoding)
+    {
+        case Encoding::unsigned8:
+            mixFrames(frames, bytesPerFrame, offsets, destination, numSamples, [](const char* p) {
+                return fixedToFloat(static_cast<juce::uint32>(static_cast<juce::uint8>(*p - 128)) << 24);
+            });
+            break;
+
+        case Encoding::signed8:
+            mixFrames(frames, bytesPerFrame, offsets, destination, numSamples, [](const char* p) {
+                return fixedToFloat(static_cast<juce::uint32>(static_cast<juce::uint8>(*p)) << 24);
+            });
+            break;
+
+        case Encoding::int16:
+            if (littleEndian)
+                mixFrames(frames, bytesPerFrame, offsets, destination, numSamples, [](const char* p) {
+                    return fixedToFloat(static_cast<juce::uint32>(juce::ByteOrder::littleEndianShort(p)) << 16);
+                });
+            else
+                mixFrames(frames, bytesPerFrame, offsets, destination, numSamples, [](const char* p) {
+                    return fixedToFloat(static_cast<juce::uint32>(juce::ByteOrder::bigEndianShort(p)) << 16);
+                });
+            break;
+
+        case Encoding::int24:
+            if (littleEndian)
+                mixFrames(frames, bytesPerFrame, offsets, destination, numSamples, [](const char* p) {
+                    return fixedToFloat(static_cast<juce::uint32>(juce::ByteOrder::littleEndian24Bit(p)) << 8);
+                });
+            else
+                mixFrames(frames, bytesPerFrame, offsets, destination, numSamples, [](const char* p) {
+                    return fixedToFloat(static_cast<juce::uint32>(juce::ByteOrder::bigEndian24Bit(p)) << 8);
+                });
+            break;
+
+        case Encoding::int32:
+            if (littleEndian)
+                mixFrames(frames, bytesPerFrame, offsets, destination, numSamples, [](const char* p) {
+                    return fixedToFloat(juce::ByteOrder::littleEndianInt(p));
+                });
+            else
+                mixFrames(frames, bytesPerFrame, offsets, destination, numSamples, [](const char* p) {
+                    return fixedToFloat(juce::ByteOrder::bigEndianInt(p));
+                });
+            break;
+
+        case Encoding::float32:
+            if (littleEndian)
+                mixFrames(frames, bytesPerFrame, offsets, destination, numSamples, [](const char* p) {
+                    return floatBits(juce::ByteOrder::littleEndianInt(p));
+                });
+            else
+                mixFrames(frames, bytesPerFrame, offsets, destination, numSamples, [](const char* p) {
+                    return floatBits(juce::ByteOrder::bigEndianInt(p));
+                });
+            break;
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <memory>
+#include <vector>
+
+// Zero-copy ingestion for the batch tools. WAV and AIFF files are opened through
+// juce::MemoryMappedAudioFormatReader and the analysis downmix is computed straight
+// from the mapped pages: each frame's samples are converted to float and summed in
+// one pass, with no decode buffer in between. The result is bit for bit what
+// AudioFormatReader::read, SampleSanitizer::replaceNonFinite and the vector downmix
+// give, only without writing and re-reading every channel.
+//
+// Plain PCM (8, 16, 24 and 32 bit) and 32-bit float are mapped; compressed formats
+// and other encodings make open() fail, and the caller streams them instead.
+class MappedAudio
+{
+public:
+    MappedAudio();
+    ~MappedAudio();
+
+    bool open(const juce::File& file, juce::AudioFormatManager& formats);
+    void close();
+    bool isOpen() const { return reader != nullptr; }
+
+    // Maps the samples [start, end) of the file; false if the system could not
+    bool map(juce::int64 start, juce::int64 end);
+
+    // Average of the given channels (indices past the file's channels are left
+    // out, as in the streaming downmix) for mapped samples from position on.
+    // Clears the destination when none of the channels exist.
+    void downmix(juce::int64 position, int numSamples, const std::vector<int>& channels, float* destination);
+
+private:
+    enum class Encoding
+    {
+        unsigned8,      // WAV
+        signed8,        // AIFF
+        int16,
+        int24,
+        int32,
+        float32
+    };
+
+    std::unique_ptr<juce::MemoryMappedAudioFormatReader> reader;
+    Encoding encoding = Encoding::int16;
+    bool littleEndian = true;
+    int bytesPerSample = 2;
+    int bytesPerFrame = 2;
+    std::vector<int> offsets;           // byte offsets of the mixed channels in a frame
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MappedAudio)
+};
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_audio_formats/juce_audio_formats.h>
+#include "BenchmarkTiming.h"
+#include "PluginProcessor.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Helpers shared by the tools that score the processor's output against
+// labelled onsets: the recordings, a render through a fresh processor and the
+// engagements of the enhancement found in its output
+namespace OnsetEvaluation
+{
+    struct Recording
+    {
+        juce::String name;
+        juce::AudioBuffer<float> audio;
+        double sampleRate = 44100.0;
+        std::vector<juce::int64> onsets;   // samples, ascending
+    };
+
+    // BenchmarkTiming::synthesizeFootsteps with their onsets, always the same take
+    inline Recording synthesize(double sampleRate, double seconds)
+    {
+        Recording recording;
+        recording.name = "synthetic";
+        recording.sampleRate = sampleRate;
+        recording.audio = BenchmarkTiming::synthesizeFootsteps(sampleRate, seconds, 1234, &recording.onsets);
+        return recording;
+    }
+
+    // The audio as a stereo insert sees it (mono doubled, further channels dropped)
+    // and its labels. An empty label file is a recording that should stay silent.
+    inline bool load(const juce::File& audioFile, const juce::File& labelFile, Recording& recording)
+    {
+        juce::AudioFormatManager formats;
+        formats.registerBasicFormats();
+
+        std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(audioFile));
+        if (reader == nullptr || !labelFile.existsAsFile())
+            return false;
+
+        recording.name = audioFile.getFileName();
+        recording.sampleRate = reader->sampleRate;
+        recording.audio.setSize(2, static_cast<int>(reader->lengthInSamples));
+        reader->read(&recording.audio, 0, recording.audio.getNumSamples(), 0, true, true);
+
+        recording.onsets = BenchmarkTiming::readOnsetLabels(labelFile, recording.sampleRate);
+        return true;
+    }
+
+    struct RenderSettings
+    {
+        int tier = 0;                   // as "modelTier"
+        float sensitivity = 0.8f;       // the plugin's default
+        float lookaheadMs = 0.0f;
+        int blockSize = 512;
+        float budgetMs = -1.0f;         // background analysis budget, < 0 = inline detection
+        bool offline = false;           // render as a non-realtime bounce
+    };
+
+    struct Render
+    {
+        juce::AudioBuffer<float> output;
+        int latency = 0;                    // samples, as reported to the host
+        juce::int64 fallbacks = 0;          // background analysis only
+        std::vector<double> blockMicros;    // processBlock time per block
+    };
+
+    // Runs a fresh processor over the recording in blocks, with the CPU guard off so
+    // results do not depend on machine load. Background analysis runs against real
+    // time, so its blocks are paced in it.
+    inline Render render(const Recording& recording, const RenderSettings& settings)
+    {
+        using BenchmarkTiming::setParameter;
+        BenchmarkTiming::ScopedSilence silence;
+
+        FootstepDetectorAudioProcessor processor;
+        setParameter(processor, "modelTier", static_cast<float>(settings.tier));
+        setParameter(processor, "sensitivity", settings.sensitivity);
+        setParameter(processor, "lookahead", settings.lookaheadMs);
+        setParameter(processor, "cpuGuard", 0.0f);
+        setParameter(processor, "backgroundAnalysis", settings.budgetMs >= 0.0f ? 1.0f : 0.0f);
+        if (settings.budgetMs >= 0.0f)
+            setParameter(processor, "latencyBudget", settings.budgetMs);
+
+        const int blockSize = settings.blockSize;
+        processor.setNonRealtime(settings.offline);
+        processor.prepareToPlay(recording.sampleRate, blockSize);
+
+        Render result;
+        result.latency = processor.getLatencySamples();
+        result.output = recording.audio;
+        result.blockMicros.reserve(static_cast<size_t>(recording.audio.getNumSamples() / blockSize + 1));
+
+        auto& output = result.output;
+        juce::AudioBuffer<float> block(2, blockSize);
+        juce::MidiBuffer midi;
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+
+        for (int start = 0; start < output.getNumSamples(); start += blockSize) {
+            const int numSamples = juce::jmin(blockSize, output.getNumSamples() - start);
+            block.setSize(2, numSamples, false, false, true);
+            for (int channel = 0; channel < 2; ++channel)
+                block.copyFrom(channel, 0, output, channel, start, numSamples);
+
+            const auto blockTicks = juce::Time::getHighResolutionTicks();
+            processor.processBlock(block, midi);
+            result.blockMicros.push_back(BenchmarkTiming::millisecondsSince(blockTicks) * 1000.0);
+
+            for (int channel = 0; channel < 2; ++channel)
+                output.copyFrom(channel, start, block, channel, 0, numSamples);
+
+            if (settings.budgetMs >= 0.0f) {
+                const double wait = (start + numSamples) * 1000.0 / recording.sampleRate - BenchmarkTiming::millisecondsSince(startTicks);
+                if (wait > 0.0)
+                    juce::Thread::sleep(static_cast<int>(wait));
+            }
+        }
+
+        result.fallbacks = processor.getAnalysisFallbackCount();
+        return result;
+    }
+
+    // The processor's final safety limit, applied to the dry signal too
+    constexpr float outputCeiling = 0.9f;
+
+    // Engagements of the enhancement, in input time: the first output sample that
+    // differs from the limited input delayed by the latency, after at least 10 ms
+    // without any difference
+    inline std::vector<juce::int64> findGainStarts(const Recording& recording, const Render& rendered)
+    {
+        std::vector<juce::int64> starts;
+        const int minimumGap = static_cast<int>(recording.sampleRate * 0.01);
+        int quietFor = minimumGap;
+
+        for (int n = rendered.latency; n < rendered.output.getNumSamples(); ++n) {
+            bool enhanced = false;
+            for (int channel = 0; channel < 2; ++channel) {
+                const float dry = juce::jlimit(-outputCeiling, outputCeiling, recording.audio.getSample(channel, n - rendered.latency));
+                enhanced = enhanced || std::abs(rendered.output.getSample(channel, n) - dry) > 1.0e-6f;
+            }
+
+            if (enhanced && quietFor >= minimumGap)
+                starts.push_back(n - rendered.latency);
+            quietFor = enhanced ? 0 : quietFor + 1;
+        }
+
+        return starts;
+    }
+
+    inline double percentile(std::vector<double> values, double fraction)
+    {
+        if (values.empty())
+            return 0.0;
+        std::sort(values.begin(), values.end());
+        return values[std::min(values.size() - 1, static_cast<size_t>(fraction * values.size()))];
+    }
+}
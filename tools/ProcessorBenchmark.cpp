@@ -0,0 +1,520 @@
+#include <juce_audio_processors/juce_audio_processors.h>
+#include "BenchmarkTiming.h"
+#include "PluginProcessor.h"
+#include <iostream>
+#include <iomanip>
+#include <limits>
+
+// Benchmarks of the complete FootstepDetectorAudioProcessor, hosted in-process.
+//
+// Usage: ProcessorBenchmark [--section=all|lifecycle|eq|sanitize|background|guard|surround] [--iterations=N]
+//
+// "lifecycle" section: what a host pays per instance
+//  - scan:     construct, query name/buses/parameters/state, destroy
+//  - create:   construct, prepareToPlay, one processBlock, destroy
+//  - prepare:  prepareToPlay on a live instance, same and changed config
+//
+// "eq" section: stereo enhancement EQ cost per sample at 64-4096 sample blocks
+//  - IIR x3:   three juce::dsp::IIR::Filter per channel plus gain (original cascade)
+//  - parallel: FootstepEQ, one bandpass plus mix with both channels in SIMD lanes
+// and the largest deviation of the FootstepEQ response from the cascade
+//
+// "sanitize" section: NaN/Inf guard cost per sample at 64-4096 sample blocks
+//  - per-sample: std::isnan/std::isinf test and branch on every sample (original)
+//  - vector:     SampleSanitizer::replaceNonFinite on a clean block (one scan)
+//  - dirty:      the same with one NaN in the block (scan plus zeroing pass)
+//
+// "background" section: processBlock cost on the audio thread per model tier,
+// detection inline and on the background worker. Blocks are paced in real time
+// (as an audio device would call them) so the worker runs against its deadline;
+// fallbacks count the chunks the energy gate had to decide.
+//
+// "guard" section: Full Forest selected, 10 s of audio at small block sizes,
+// CPU guard off and on. Overruns are blocks that took longer than their own
+// real-time length; the level columns show where the guard settled.
+//
+// "surround" section: mean processBlock time per layout (mono to 7.1.4) and analysis
+// mix, at 48 kHz / 512 samples. Built-in and Full Forest inline run back to
+// back; Full Forest on the workers is paced in real time and shows what stays
+// on the audio thread when each speaker group has its own worker.
+
+namespace
+{
+    using BenchmarkTiming::TimingStats;
+    using BenchmarkTiming::measure;
+
+    using BenchmarkTiming::ScopedSilence;
+    using BenchmarkTiming::setParameter;
+
+    void printRow(const char* name, const TimingStats& stats)
+    {
+        std::cout << std::left << std::setw(28) << name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(12) << stats.meanMicros << std::setw(12) << stats.p50Micros
+                  << std::setw(12) << stats.p99Micros << std::setw(12) << stats.maxMicros << std::endl;
+    }
+
+    void benchmarkLifecycle(int iterations)
+    {
+        const double sampleRate = 48000.0;
+        const int blockSize = 512;
+
+        juce::AudioBuffer<float> buffer(2, blockSize);
+        juce::MidiBuffer midi;
+        juce::MemoryBlock state;
+
+        TimingStats scan, create, sameConfig, changedConfig;
+        {
+            ScopedSilence silence;
+
+            scan = measure([&] {
+                FootstepDetectorAudioProcessor processor;
+                volatile int sink = processor.getName().length() + processor.getNumParameters()
+                                  + processor.getTotalNumInputChannels() + (processor.hasEditor() ? 1 : 0);
+                juce::ignoreUnused(sink);
+                processor.getStateInformation(state);
+            }, iterations);
+
+            create = measure([&] {
+                FootstepDetectorAudioProcessor processor;
+                processor.prepareToPlay(sampleRate, blockSize);
+                buffer.clear();
+                processor.processBlock(buffer, midi);
+            }, iterations);
+
+            FootstepDetectorAudioProcessor processor;
+            processor.prepareToPlay(sampleRate, blockSize);
+
+            sameConfig = measure([&] { processor.prepareToPlay(sampleRate, blockSize); }, iterations);
+
+            bool alternate = false;
+            changedConfig = measure([&] {
+                alternate = !alternate;
+                processor.prepareToPlay(alternate ? 44100.0 : sampleRate, blockSize);
+            }, iterations);
+        }
+
+        std::cout << std::endl << "PROCESSOR LIFECYCLE (" << iterations << " iterations, "
+                  << sampleRate << " Hz, " << blockSize << " samples)" << std::endl;
+        std::cout << std::left << std::setw(28) << "Operation" << std::right
+                  << std::setw(12) << "Mean(us)" << std::setw(12) << "P50(us)"
+                  << std::setw(12) << "P99(us)" << std::setw(12) << "Max(us)" << std::endl;
+
+        printRow("scan (construct+query)", scan);
+        printRow("create (+prepare+block)", create);
+        printRow("re-prepare, same config", sameConfig);
+        printRow("re-prepare, new rate", changedConfig);
+    }
+
+    void benchmarkEQ(int iterations)
+    {
+        using Filter = juce::dsp::IIR::Filter<float>;
+        using Coefficients = juce::dsp::IIR::Coefficients<float>;
+
+        const double sampleRate = 48000.0;
+        const int numChannels = 2;
+
+        std::cout << std::endl << "STEREO EQ (" << iterations << " iterations, " << sampleRate << " Hz, "
+                  << FootstepEQ::Vec::size() << " SIMD lanes)" << std::endl;
+        std::cout << std::right << std::setw(8) << "Block" << std::setw(16) << "IIR x3(ns/smp)"
+                  << std::setw(18) << "Parallel(ns/smp)" << std::setw(10) << "Speedup" << std::endl;
+
+        // As in processBlock; every call also restores the input, so repeated in-place
+        // filtering never decays into denormals
+        juce::ScopedNoDenormals noDenormals;
+        juce::Random random(7);
+
+        for (int blockSize = 64; blockSize <= 4096; blockSize *= 2)
+        {
+            juce::AudioBuffer<float> input(numChannels, blockSize);
+            for (int channel = 0; channel < numChannels; ++channel)
+                for (int i = 0; i < blockSize; ++i)
+                    input.setSample(channel, i, (random.nextFloat() * 2.0f - 1.0f) * 0.25f);
+
+            juce::AudioBuffer<float> buffer(input);
+
+            // Original implementation: one filter object per band and channel, run in turn
+            std::vector<std::array<Filter, 3>> filters(numChannels);
+            for (auto& bands : filters) {
+                bands[0].coefficients = Coefficients::makeLowShelf(sampleRate, 180.0f, 0.8f, 1.189f);
+                bands[1].coefficients = Coefficients::makePeakFilter(sampleRate, 300.0f, 0.7f, 1.148f);
+                bands[2].coefficients = Coefficients::makePeakFilter(sampleRate, 450.0f, 0.6f, 1.122f);
+            }
+
+            FootstepEQ eq;
+            eq.prepare(sampleRate, blockSize, numChannels);
+
+            juce::dsp::AudioBlock<float> block(buffer);
+
+            // Keep each timed batch around 4096 samples so short blocks stay above timer resolution
+            const int batchSize = juce::jmax(1, 4096 / blockSize);
+
+            TimingStats separate = measure([&] {
+                buffer.makeCopyOf(input, true);
+                for (int channel = 0; channel < numChannels; ++channel) {
+                    auto channelBlock = block.getSingleChannelBlock(static_cast<size_t>(channel));
+                    juce::dsp::ProcessContextReplacing<float> context(channelBlock);
+                    for (auto& filter : filters[static_cast<size_t>(channel)])
+                        filter.process(context);
+                    juce::FloatVectorOperations::multiply(buffer.getWritePointer(channel), 0.85f, blockSize);
+                }
+            }, iterations, batchSize);
+
+            TimingStats parallel = measure([&] {
+                buffer.makeCopyOf(input, true);
+                eq.process(juce::dsp::ProcessContextReplacing<float>(block));
+            }, iterations, batchSize);
+
+            const double toNanosPerSample = 1000.0 / blockSize;
+            std::cout << std::setw(8) << blockSize << std::fixed << std::setprecision(2)
+                      << std::setw(16) << separate.p50Micros * toNanosPerSample
+                      << std::setw(18) << parallel.p50Micros * toNanosPerSample
+                      << std::setw(9) << separate.p50Micros / parallel.p50Micros << "x" << std::endl;
+        }
+
+        // Response check: parallel form against the cascade it replaces, 20 Hz - 20 kHz
+        for (double rate : { 44100.0, 48000.0, 96000.0, 192000.0 })
+        {
+            FootstepEQ eq;
+            eq.prepare(rate, 64, numChannels);
+
+            const Coefficients::Ptr cascade[] = {
+                Coefficients::makeLowShelf(rate, 180.0f, 0.8f, 1.189f),
+                Coefficients::makePeakFilter(rate, 300.0f, 0.7f, 1.148f),
+                Coefficients::makePeakFilter(rate, 450.0f, 0.6f, 1.122f)
+            };
+
+            double maxDeviation = 0.0;
+            for (double frequency = 20.0; frequency <= juce::jmin(20000.0, rate * 0.45); frequency *= 1.02) {
+                double reference = 0.85;
+                for (auto& band : cascade)
+                    reference *= band->getMagnitudeForFrequency(frequency, rate);
+
+                maxDeviation = juce::jmax(maxDeviation, std::abs(juce::Decibels::gainToDecibels(eq.getMagnitudeForFrequency(frequency))
+                                                                 - juce::Decibels::gainToDecibels(reference)));
+            }
+
+            std::cout << "   Response vs 3-band cascade at " << std::setprecision(0) << rate << " Hz: max deviation "
+                      << std::setprecision(2) << maxDeviation << " dB" << std::endl;
+        }
+    }
+
+    void benchmarkBackgroundAnalysis(int iterations)
+    {
+        const double sampleRate = 48000.0;
+        const int blockSize = 512;
+        const double blockMs = 1000.0 * blockSize / sampleRate;
+
+        std::cout << std::endl << "BACKGROUND ANALYSIS (" << iterations << " real-time paced blocks, "
+                  << sampleRate << " Hz, " << blockSize << " samples, 10 ms budget)" << std::endl;
+        std::cout << std::left << std::setw(28) << "Tier / detection" << std::right
+                  << std::setw(12) << "Mean(us)" << std::setw(12) << "P50(us)"
+                  << std::setw(12) << "P99(us)" << std::setw(12) << "Max(us)" << std::setw(12) << "Fallbacks" << std::endl;
+
+        juce::Random random(11);
+        juce::AudioBuffer<float> input(2, blockSize * 64);
+        for (int channel = 0; channel < 2; ++channel)
+            for (int i = 0; i < input.getNumSamples(); ++i)
+                input.setSample(channel, i, (random.nextFloat() * 2.0f - 1.0f) * 0.1f);
+
+        for (int tier = 0; tier <= FootstepModel::NUM_TIERS; ++tier)
+        {
+            for (bool background : { false, true })
+            {
+                std::vector<double> samples;
+                juce::int64 fallbacks = 0;
+                {
+                    ScopedSilence silence;
+
+                    FootstepDetectorAudioProcessor processor;
+                    setParameter(processor, "modelTier", static_cast<float>(tier));
+                    setParameter(processor, "backgroundAnalysis", background ? 1.0f : 0.0f);
+                    setParameter(processor, "latencyBudget", 10.0f);
+                    setParameter(processor, "cpuGuard", 0.0f);    // measure every tier as selected
+                    processor.prepareToPlay(sampleRate, blockSize);
+
+                    juce::AudioBuffer<float> buffer(2, blockSize);
+                    juce::MidiBuffer midi;
+                    const auto startTicks = juce::Time::getHighResolutionTicks();
+
+                    for (int block = 0; block < iterations; ++block)
+                    {
+                        const int offset = (block * blockSize) % input.getNumSamples();
+                        for (int channel = 0; channel < 2; ++channel)
+                            buffer.copyFrom(channel, 0, input, channel, offset, blockSize);
+
+                        const auto blockStart = juce::Time::getHighResolutionTicks();
+                        processor.processBlock(buffer, midi);
+                        samples.push_back(BenchmarkTiming::millisecondsSince(blockStart) * 1000.0);
+
+                        // Next device callback
+                        const double wait = (block + 1) * blockMs - BenchmarkTiming::millisecondsSince(startTicks);
+                        if (wait > 0.0)
+                            juce::Thread::sleep(static_cast<int>(wait));
+                    }
+
+                    fallbacks = processor.getAnalysisFallbackCount();
+                }
+
+                std::sort(samples.begin(), samples.end());
+                TimingStats stats;
+                for (double sample : samples)
+                    stats.meanMicros += sample / double(samples.size());
+                stats.p50Micros = samples[samples.size() / 2];
+                stats.p99Micros = samples[std::min(samples.size() - 1, samples.size() * 99 / 100)];
+                stats.maxMicros = samples.back();
+
+                const juce::String name = juce::String(tier == 0 ? "Built-in" : FootstepModel::getTierName(static_cast<FootstepModel::Tier>(tier - 1)))
+                                        + (background ? ", worker" : ", inline");
+                std::cout << std::left << std::setw(28) << name << std::right << std::fixed << std::setprecision(1)
+                          << std::setw(12) << stats.meanMicros << std::setw(12) << stats.p50Micros
+                          << std::setw(12) << stats.p99Micros << std::setw(12) << stats.maxMicros
+                          << std::setw(12) << fallbacks << std::endl;
+            }
+        }
+    }
+
+    void benchmarkCpuGuard()
+    {
+        const double sampleRate = 48000.0;
+        const int fullForest = FootstepModel::NUM_TIERS;
+
+        std::cout << std::endl << "CPU GUARD (Full Forest selected, 10 s at " << sampleRate << " Hz per row)" << std::endl;
+        std::cout << std::right << std::setw(8) << "Block" << std::setw(7) << "Guard" << std::setw(11) << "Mean(us)"
+                  << std::setw(11) << "P99(us)" << std::setw(11) << "Max(us)" << std::setw(11) << "Overruns"
+                  << std::setw(9) << "Changes" << "  Time per level (gate/rules/top-15/forest)" << std::endl;
+
+        juce::Random random(5);
+        juce::AudioBuffer<float> input(2, static_cast<int>(sampleRate));
+        for (int channel = 0; channel < 2; ++channel)
+            for (int i = 0; i < input.getNumSamples(); ++i)
+                input.setSample(channel, i, (random.nextFloat() * 2.0f - 1.0f) * 0.1f);
+
+        for (int blockSize : { 32, 64, 128, 256 })
+        {
+            for (bool guard : { false, true })
+            {
+                std::vector<double> samples;
+                std::array<int, FootstepModel::NUM_TIERS + 1> blocksAtLevel {};
+                int overruns = 0;
+                juce::int64 changes = 0;
+                {
+                    ScopedSilence silence;
+
+                    FootstepDetectorAudioProcessor processor;
+                    setParameter(processor, "modelTier", static_cast<float>(fullForest));
+                    setParameter(processor, "cpuGuard", guard ? 1.0f : 0.0f);
+                    processor.prepareToPlay(sampleRate, blockSize);
+
+                    juce::AudioBuffer<float> buffer(2, blockSize);
+                    juce::MidiBuffer midi;
+                    const int numBlocks = static_cast<int>(sampleRate * 10.0) / blockSize;
+                    const double blockMicros = 1.0e6 * blockSize / sampleRate;
+
+                    for (int block = 0; block < numBlocks; ++block)
+                    {
+                        const int offset = (block * blockSize) % (input.getNumSamples() - blockSize);
+                        for (int channel = 0; channel < 2; ++channel)
+                            buffer.copyFrom(channel, 0, input, channel, offset, blockSize);
+
+                        blocksAtLevel[static_cast<size_t>(juce::jlimit(0, fullForest, processor.getDetectionLevel()))]++;
+
+                        const auto blockStart = juce::Time::getHighResolutionTicks();
+                        processor.processBlock(buffer, midi);
+                        samples.push_back(BenchmarkTiming::millisecondsSince(blockStart) * 1000.0);
+
+                        if (samples.back() > blockMicros)
+                            overruns++;
+                    }
+
+                    changes = processor.getDegradeLadder().getNumChanges();
+                }
+
+                std::sort(samples.begin(), samples.end());
+                double mean = 0.0;
+                for (double sample : samples)
+                    mean += sample / double(samples.size());
+
+                std::cout << std::setw(8) << blockSize << std::setw(7) << (guard ? "on" : "off") << std::fixed << std::setprecision(1)
+                          << std::setw(11) << mean << std::setw(11) << samples[std::min(samples.size() - 1, samples.size() * 99 / 100)]
+                          << std::setw(11) << samples.back()
+                          << std::setw(10) << 100.0 * overruns / double(samples.size()) << "%" << std::setw(9) << changes << " ";
+
+                for (int count : blocksAtLevel)
+                    std::cout << std::setw(6) << juce::roundToInt(100.0 * count / double(samples.size())) << "%";
+                std::cout << std::endl;
+            }
+        }
+    }
+
+    void benchmarkSanitize(int iterations)
+    {
+        std::cout << std::endl << "NAN/INF GUARD (" << iterations << " iterations)" << std::endl;
+        std::cout << std::right << std::setw(8) << "Block" << std::setw(20) << "Per-sample(ns/smp)"
+                  << std::setw(14) << "Vector(ns/smp)" << std::setw(10) << "Speedup"
+                  << std::setw(14) << "Dirty(ns/smp)" << std::endl;
+
+        juce::Random random(11);
+
+        for (int blockSize = 64; blockSize <= 4096; blockSize *= 2)
+        {
+            // Offset by one sample so the vector pass also covers an unaligned head
+            std::vector<float> storage(static_cast<size_t>(blockSize + 1));
+            float* samples = storage.data() + 1;
+            for (int i = 0; i < blockSize; ++i)
+                samples[i] = (random.nextFloat() * 2.0f - 1.0f) * 0.25f;
+
+            const int batchSize = juce::jmax(1, 4096 / blockSize);
+
+            TimingStats perSample = measure([&] {
+                for (int i = 0; i < blockSize; ++i)
+                    if (std::isnan(samples[i]) || std::isinf(samples[i]))
+                        samples[i] = 0.0f;
+            }, iterations, batchSize);
+
+            TimingStats vector = measure([&] {
+                SampleSanitizer::replaceNonFinite(samples, blockSize);
+            }, iterations, batchSize);
+
+            TimingStats dirty = measure([&] {
+                samples[blockSize / 2] = std::numeric_limits<float>::quiet_NaN();
+                SampleSanitizer::replaceNonFinite(samples, blockSize);
+            }, iterations, batchSize);
+
+            const double toNanosPerSample = 1000.0 / blockSize;
+            std::cout << std::setw(8) << blockSize << std::fixed << std::setprecision(3)
+                      << std::setw(20) << perSample.p50Micros * toNanosPerSample
+                      << std::setw(14) << vector.p50Micros * toNanosPerSample
+                      << std::setw(9) << std::setprecision(2) << perSample.p50Micros / vector.p50Micros << "x"
+                      << std::setw(14) << std::setprecision(3) << dirty.p50Micros * toNanosPerSample << std::endl;
+        }
+    }
+
+    void benchmarkSurround(int iterations)
+    {
+        const double sampleRate = 48000.0;
+        const int blockSize = 512;
+        const double blockMs = 1000.0 * blockSize / sampleRate;
+        const int fullForest = FootstepModel::NUM_TIERS;
+
+        std::cout << std::endl << "SURROUND (" << iterations << " blocks per run, " << sampleRate << " Hz, "
+                  << blockSize << " samples, mean per block)" << std::endl;
+        std::cout << std::left << std::setw(10) << "Layout" << std::right << std::setw(4) << "Ch" << "  "
+                  << std::left << std::setw(16) << "Analysis mix" << std::right << std::setw(8) << "Signals"
+                  << std::setw(14) << "Built-in(us)" << std::setw(10) << "us/ch" << std::setw(13) << "Forest(us)"
+                  << std::setw(15) << "Workers(us)" << std::setw(11) << "Fallbacks" << std::endl;
+
+        const std::pair<const char*, juce::AudioChannelSet> layouts[] = {
+            { "Mono",   juce::AudioChannelSet::mono() },
+            { "Stereo", juce::AudioChannelSet::stereo() },
+            { "5.1",    juce::AudioChannelSet::create5point1() },
+            { "7.1",    juce::AudioChannelSet::create7point1() },
+            { "7.1.4",  juce::AudioChannelSet::create7point1point4() }
+        };
+
+        juce::Random random(13);
+
+        for (const auto& [layoutName, layout] : layouts)
+        {
+            const int numChannels = layout.size();
+            juce::AudioBuffer<float> input(numChannels, blockSize * 64);
+            for (int channel = 0; channel < numChannels; ++channel)
+                for (int i = 0; i < input.getNumSamples(); ++i)
+                    input.setSample(channel, i, (random.nextFloat() * 2.0f - 1.0f) * 0.1f);
+
+            for (int mix = 0; mix <= 2; ++mix)
+            {
+                int numSignals = 0;
+                juce::int64 fallbacks = 0;
+
+                auto run = [&](int tier, bool background) {
+                    std::vector<double> samples;
+                    ScopedSilence silence;
+
+                    FootstepDetectorAudioProcessor processor;
+                    setParameter(processor, "modelTier", static_cast<float>(tier));
+                    setParameter(processor, "backgroundAnalysis", background ? 1.0f : 0.0f);
+                    setParameter(processor, "latencyBudget", 10.0f);
+                    setParameter(processor, "cpuGuard", 0.0f);
+                    setParameter(processor, "analysisMix", static_cast<float>(mix));
+
+                    juce::AudioProcessor::BusesLayout buses;
+                    buses.inputBuses.add(layout);
+                    buses.outputBuses.add(layout);
+                    processor.setBusesLayout(buses);
+                    processor.prepareToPlay(sampleRate, blockSize);
+                    numSignals = processor.getNumAnalysisSignals();
+
+                    juce::AudioBuffer<float> buffer(numChannels, blockSize);
+                    juce::MidiBuffer midi;
+                    const auto startTicks = juce::Time::getHighResolutionTicks();
+
+                    for (int block = 0; block < iterations; ++block)
+                    {
+                        const int offset = (block * blockSize) % input.getNumSamples();
+                        for (int channel = 0; channel < numChannels; ++channel)
+                            buffer.copyFrom(channel, 0, input, channel, offset, blockSize);
+
+                        const auto blockStart = juce::Time::getHighResolutionTicks();
+                        processor.processBlock(buffer, midi);
+                        samples.push_back(BenchmarkTiming::millisecondsSince(blockStart) * 1000.0);
+
+                        const double wait = (block + 1) * blockMs - BenchmarkTiming::millisecondsSince(startTicks);
+                        if (background && wait > 0.0)
+                            juce::Thread::sleep(static_cast<int>(wait));
+                    }
+
+                    if (background)
+                        fallbacks = processor.getAnalysisFallbackCount();
+
+                    double mean = 0.0;
+                    for (double sample : samples)
+                        mean += sample / double(samples.size());
+                    return mean;
+                };
+
+                const double builtIn = run(0, false);
+                const double forest = run(fullForest, false);
+                const double workers = run(fullForest, true);
+
+                static const char* mixNames[] = { "All Speakers", "Front Speakers", "Speaker Groups" };
+                std::cout << std::left << std::setw(10) << layoutName << std::right << std::setw(4) << numChannels << "  "
+                          << std::left << std::setw(16) << mixNames[mix] << std::right << std::setw(8) << numSignals
+                          << std::fixed << std::setprecision(1)
+                          << std::setw(14) << builtIn << std::setw(10) << builtIn / numChannels
+                          << std::setw(13) << forest << std::setw(15) << workers << std::setw(11) << fallbacks << std::endl;
+            }
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList args(argc, argv);
+
+    int iterations = 200;
+    if (args.containsOption("--iterations"))
+        iterations = std::max(10, args.getValueForOption("--iterations").getIntValue());
+
+    juce::String section = args.containsOption("--section") ? args.getValueForOption("--section") : juce::String("all");
+
+    if (section == "all" || section == "lifecycle")
+        benchmarkLifecycle(iterations);
+
+    if (section == "all" || section == "eq")
+        benchmarkEQ(iterations);
+
+    if (section == "all" || section == "sanitize")
+        benchmarkSanitize(iterations);
+
+    if (section == "all" || section == "background")
+        benchmarkBackgroundAnalysis(iterations);
+
+    if (section == "all" || section == "guard")
+        benchmarkCpuGuard();
+
+    if (section == "all" || section == "surround")
+        benchmarkSurround(iterations);
+
+    return 0;
+}
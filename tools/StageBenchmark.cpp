@@ -0,0 +1,293 @@
+#include <juce_audio_processors/juce_audio_processors.h>
+#include "BenchmarkTiming.h"
+#include "FootstepEQ.h"
+#include "MFCCExtractor.h"
+#include "MLFootstepClassifier.h"
+#include "PluginProcessor.h"
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+
+// Microbenchmarks of every detection and DSP stage, swept over sample rates and
+// block sizes, as JSON for regression tracking.
+//
+// Usage: StageBenchmark [--stages=<name,...>] [--sample-rates=44100,...] [--block-sizes=16,...]
+//                       [--iterations=N] [--tier=N] [--output=<file>]
+//
+// Stages (all by default):
+//  - features:  MLFootstepClassifier::extractFeatures on one 2048-sample window
+//  - inference: MLFootstepClassifier::runSimpleInference on one feature vector
+//  - mfcc:      MFCCExtractor::extractFeatures on one 2048-sample window
+//  - frame:     MFCCExtractor::processSingleFrame on one zero-padded frame
+//  - eq:        FootstepEQ::process on a stereo block
+//  - block:     FootstepDetectorAudioProcessor::processBlock on a stereo block, detection
+//               inline on the calling thread (no background worker, CPU guard off) with
+//               the --tier model, over at least two seconds of audio per configuration
+//
+// Window stages run at every sample rate (inference once: it does not depend on it),
+// block stages at every sample rate and block size; defaults are 44.1, 48, 88.2, 96,
+// 176.4 and 192 kHz and blocks of 16 to 4096 samples. Each measurement warms up for a
+// tenth of its iterations, then times every iteration; block stages shorter than
+// 4096 samples are timed in batches that long, so they stay above timer resolution.
+// The input is noise with footstep-like thumps, so the detector takes its decisions.
+//
+// The JSON (to --output, or stdout) lists one entry per stage and configuration with
+// mean, p50, p90, p99 and max in microseconds; block stages add ns per sample and the
+// real-time factor (p50 and p99 time over the block's duration). processBlock is
+// timed per callback, so its percentiles are only as fine as the timer resolution
+// recorded with the machine. Progress is printed to stderr.
+
+class StageBenchmark
+{
+public:
+    static void extractFeatures(const MLFootstepClassifier& classifier, const float* window, float* features)
+    {
+        classifier.extractFeatures(window, MLFootstepClassifier::WINDOW_SIZE, features);
+    }
+
+    static float runSimpleInference(MLFootstepClassifier& classifier, const float* features)
+    {
+        return classifier.runSimpleInference(features);
+    }
+
+    static void processSingleFrame(MFCCExtractor& extractor, const float* frame)
+    {
+        // Frames accumulate until the next extractFeatures; keep them in the fixed list
+        if (extractor.numFrames >= MFCCExtractor::MAX_FRAMES)
+            extractor.numFrames = 0;
+        extractor.processSingleFrame(frame);
+    }
+};
+
+namespace
+{
+    using BenchmarkTiming::TimingStats;
+    using BenchmarkTiming::measure;
+
+    using BenchmarkTiming::ScopedSilence;
+    using BenchmarkTiming::setParameter;
+
+    // Two seconds of the shared synthetic footsteps, one channel
+    std::vector<float> makeSignal(double sampleRate)
+    {
+        const auto audio = BenchmarkTiming::synthesizeFootsteps(sampleRate, 2.0, 21);
+        return std::vector<float>(audio.getReadPointer(0), audio.getReadPointer(0) + audio.getNumSamples());
+    }
+
+    std::vector<int> parseList(const juce::String& list)
+    {
+        std::vector<int> values;
+        for (const auto& token : juce::StringArray::fromTokens(list, ",", ""))
+            if (token.trim().getDoubleValue() > 0.0)
+                values.push_back(juce::roundToInt(token.trim().getDoubleValue()));
+        return values;
+    }
+
+    class Report
+    {
+    public:
+        void add(const juce::String& stage, double sampleRate, int blockSize, int iterations, const TimingStats& stats)
+        {
+            auto* entry = new juce::DynamicObject();
+            entry->setProperty("stage", stage);
+            entry->setProperty("sample_rate", sampleRate > 0.0 ? juce::var(sampleRate) : juce::var());
+            entry->setProperty("block_size", blockSize > 0 ? juce::var(blockSize) : juce::var());
+            entry->setProperty("iterations", iterations);
+            entry->setProperty("mean_us", stats.meanMicros);
+            entry->setProperty("p50_us", stats.p50Micros);
+            entry->setProperty("p90_us", stats.p90Micros);
+            entry->setProperty("p99_us", stats.p99Micros);
+            entry->setProperty("max_us", stats.maxMicros);
+
+            if (blockSize > 0) {
+                const double blockMicros = 1.0e6 * blockSize / sampleRate;
+                entry->setProperty("ns_per_sample", stats.p50Micros * 1000.0 / blockSize);
+                entry->setProperty("rtf_p50", stats.p50Micros / blockMicros);
+                entry->setProperty("rtf_p99", stats.p99Micros / blockMicros);
+            }
+
+            results.add(juce::var(entry));
+
+            std::cerr << std::left << std::setw(10) << stage << std::right << std::fixed << std::setprecision(0)
+                      << std::setw(8) << sampleRate << std::setw(6) << blockSize << std::setprecision(2)
+                      << "  p50 " << std::setw(10) << stats.p50Micros << " us  p99 " << std::setw(10) << stats.p99Micros << " us" << std::endl;
+        }
+
+        juce::String toJson(int iterations, int tier) const
+        {
+            auto* machine = new juce::DynamicObject();
+            machine->setProperty("cpu", juce::SystemStats::getCpuModel());
+            machine->setProperty("cores", juce::SystemStats::getNumCpus());
+            machine->setProperty("os", juce::SystemStats::getOperatingSystemName());
+            machine->setProperty("juce", juce::SystemStats::getJUCEVersion());
+            machine->setProperty("timer_resolution_us", 1.0e6 / double(juce::Time::getHighResolutionTicksPerSecond()));
+
+            auto* config = new juce::DynamicObject();
+            config->setProperty("iterations", iterations);
+            config->setProperty("tier", tier);
+            config->setProperty("simd_lanes", static_cast<int>(FootstepEQ::Vec::size()));
+
+            auto* root = new juce::DynamicObject();
+            root->setProperty("benchmark", "StageBenchmark");
+            root->setProperty("time", juce::Time::getCurrentTime().toISO8601(true));
+            root->setProperty("machine", juce::var(machine));
+            root->setProperty("config", juce::var(config));
+            root->setProperty("results", results);
+            return juce::JSON::toString(juce::var(root));
+        }
+
+    private:
+        juce::Array<juce::var> results;
+    };
+
+    void benchmarkWindowStages(Report& report, const juce::StringArray& stages, double sampleRate, int iterations, bool withInference)
+    {
+        const auto signal = makeSignal(sampleRate);
+        const float* window = signal.data() + static_cast<size_t>(sampleRate * 0.225) - MLFootstepClassifier::WINDOW_SIZE / 2;
+
+        ScopedSilence silence;
+
+        MLFootstepClassifier classifier;
+        classifier.loadModel("");
+        classifier.prepare(sampleRate, 512);
+
+        std::array<float, 32> features {};
+        volatile float sink = 0.0f;
+
+        if (stages.contains("features"))
+            report.add("features", sampleRate, 0, iterations, measure([&] {
+                StageBenchmark::extractFeatures(classifier, window, features.data());
+                sink = features[0];
+            }, iterations));
+
+        if (withInference && stages.contains("inference")) {
+            StageBenchmark::extractFeatures(classifier, window, features.data());
+            report.add("inference", 0.0, 0, iterations, measure([&] {
+                sink = StageBenchmark::runSimpleInference(classifier, features.data());
+            }, iterations, 64));
+        }
+
+        MFCCExtractor extractor;
+        extractor.prepare(sampleRate);
+
+        if (stages.contains("mfcc"))
+            report.add("mfcc", sampleRate, 0, iterations, measure([&] {
+                sink = extractor.extractFeatures(window, MFCCExtractor::WINDOW_SIZE)[0];
+            }, iterations));
+
+        if (stages.contains("frame")) {
+            // As extractFeatures calls it: 512 samples, zero-padded to the FFT size
+            std::vector<float> frame(MFCCExtractor::WINDOW_SIZE, 0.0f);
+            std::copy(window, window + MFCCExtractor::FRAME_SIZE, frame.begin());
+            report.add("frame", sampleRate, 0, iterations, measure([&] {
+                StageBenchmark::processSingleFrame(extractor, frame.data());
+            }, iterations));
+        }
+
+        juce::ignoreUnused(sink);
+    }
+
+    void benchmarkBlockStages(Report& report, const juce::StringArray& stages, double sampleRate, int blockSize, int iterations, int tier)
+    {
+        const auto signal = makeSignal(sampleRate);
+        const int signalLength = static_cast<int>(signal.size()) / blockSize * blockSize;
+        const int batchSize = juce::jmax(1, 4096 / blockSize);
+
+        juce::AudioBuffer<float> buffer(2, blockSize);
+        int position = 0;
+
+        // Each call takes the next block of the signal, as a host would deliver it
+        auto nextBlock = [&] {
+            for (int channel = 0; channel < 2; ++channel)
+                buffer.copyFrom(channel, 0, signal.data() + position, blockSize);
+            position = (position + blockSize) % signalLength;
+        };
+
+        juce::ScopedNoDenormals noDenormals;
+
+        if (stages.contains("eq")) {
+            FootstepEQ eq;
+            eq.prepare(sampleRate, blockSize, 2);
+            juce::dsp::AudioBlock<float> block(buffer);
+
+            report.add("eq", sampleRate, blockSize, iterations, measure([&] {
+                nextBlock();
+                eq.process(juce::dsp::ProcessContextReplacing<float>(block));
+            }, iterations, batchSize));
+        }
+
+        if (stages.contains("block")) {
+            TimingStats stats;
+            const int numBlocks = juce::jmax(iterations, static_cast<int>(sampleRate * 2.0) / blockSize);
+            {
+                ScopedSilence silence;
+
+                FootstepDetectorAudioProcessor processor;
+                setParameter(processor, "modelTier", static_cast<float>(tier));
+                setParameter(processor, "backgroundAnalysis", 0.0f);
+                setParameter(processor, "cpuGuard", 0.0f);
+
+                processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+                processor.prepareToPlay(sampleRate, blockSize);
+                juce::MidiBuffer midi;
+
+                // One callback per timing: the per-callback distribution is the point
+                stats = measure([&] {
+                    nextBlock();
+                    processor.processBlock(buffer, midi);
+                }, numBlocks);
+
+                processor.releaseResources();
+            }
+            report.add("block", sampleRate, blockSize, numBlocks, stats);
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList args(argc, argv);
+
+    juce::StringArray stages { "features", "inference", "mfcc", "frame", "eq", "block" };
+    if (args.containsOption("--stages"))
+        stages = juce::StringArray::fromTokens(args.getValueForOption("--stages"), ",", "");
+
+    auto sampleRates = parseList(args.containsOption("--sample-rates") ? args.getValueForOption("--sample-rates")
+                                                                       : juce::String("44100,48000,88200,96000,176400,192000"));
+    auto blockSizes = parseList(args.containsOption("--block-sizes") ? args.getValueForOption("--block-sizes")
+                                                                     : juce::String("16,32,64,128,256,512,1024,2048,4096"));
+
+    const int iterations = args.containsOption("--iterations") ? juce::jmax(10, args.getValueForOption("--iterations").getIntValue()) : 200;
+    const int tier = args.containsOption("--tier") ? juce::jlimit(0, FootstepModel::NUM_TIERS, args.getValueForOption("--tier").getIntValue()) : 0;
+
+    if (sampleRates.empty() || blockSizes.empty()) {
+        std::cerr << "Usage: StageBenchmark [--stages=features,inference,mfcc,frame,eq,block] [--sample-rates=44100,...]" << std::endl
+                  << "                      [--block-sizes=16,...] [--iterations=N] [--tier=N] [--output=<file>]" << std::endl;
+        return 1;
+    }
+
+    Report report;
+
+    for (size_t index = 0; index < sampleRates.size(); ++index)
+        benchmarkWindowStages(report, stages, sampleRates[index], iterations, index == 0);
+
+    for (int sampleRate : sampleRates)
+        for (int blockSize : blockSizes)
+            benchmarkBlockStages(report, stages, sampleRate, blockSize, iterations, tier);
+
+    const auto json = report.toJson(iterations, tier);
+
+    if (args.containsOption("--output")) {
+        std::ofstream output(juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--output")).getFullPathName().toStdString());
+        if (!output) {
+            std::cerr << "Cannot write " << args.getValueForOption("--output") << std::endl;
+            return 1;
+        }
+        output << json << std::endl;
+    } else {
+        std::cout << json << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,118 @@
+#include "WorkStealingPool.h"
+#include <algorithm>
+
+WorkStealingPool::WorkStealingPool(int numWorkers)
+{
+    numWorkers = std::max(1, numWorkers);
+
+    for (int worker = 0; worker < numWorkers; ++worker)
+        queues.push_back(std::make_unique<Queue>());
+
+    for (int worker = 1; worker < numWorkers; ++worker)
+        threads.emplace_back([this, worker] { workerLoop(worker); });
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(stateLock);
+        quitting = true;
+    }
+    wake.notify_all();
+
+    for (auto& thread : threads)
+        thread.join();
+}
+
+void WorkStealingPool::run(const std::vector<int>& order, const std::function<void(int worker, int task)>& task)
+{
+    // Every worker is parked between runs, so the queues can be dealt without locking
+    const size_t numQueues = queues.size();
+    for (auto& queue : queues) {
+        queue->tasks.clear();
+        queue->tasks.reserve(order.size() / numQueues + 1);
+    }
+
+    for (size_t index = 0; index < order.size(); ++index)
+        queues[index % numQueues]->tasks.push_back(order[index]);
+
+    for (auto& queue : queues) {
+        queue->front = 0;
+        queue->back = queue->tasks.size();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(stateLock);
+        currentTask = &task;
+        workersBusy = static_cast<int>(threads.size());
+        ++generation;
+    }
+    wake.notify_all();
+
+    work(0);
+
+    std::unique_lock<std::mutex> lock(stateLock);
+    finished.wait(lock, [this] { return workersBusy == 0; });
+    currentTask = nullptr;
+}
+
+void WorkStealingPool::workerLoop(int worker)
+{
+    unsigned long long seenGeneration = 0;
+
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(stateLock);
+            wake.wait(lock, [&] { return quitting || generation != seenGeneration; });
+            if (quitting)
+                return;
+            seenGeneration = generation;
+        }
+
+        work(worker);
+
+        std::lock_guard<std::mutex> lock(stateLock);
+        if (--workersBusy == 0)
+            finished.notify_one();
+    }
+}
+
+void WorkStealingPool::work(int worker)
+{
+    // Tasks never create tasks, so nothing left to take or steal means this worker is done
+    int task = 0;
+    while (takeOwn(worker, task) || steal(worker, task))
+        (*currentTask)(worker, task);
+}
+
+bool WorkStealingPool::takeOwn(int worker, int& task)
+{
+    auto& queue = *queues[static_cast<size_t>(worker)];
+    std::lock_guard<std::mutex> lock(queue.lock);
+
+    if (queue.front == queue.back)
+        return false;
+
+    task = queue.tasks[queue.front++];
+    return true;
+}
+
+bool WorkStealingPool::steal(int worker, int& task)
+{
+    // Victims in turn from the next worker on, from the back: the smallest tasks they hold
+    const int numQueues = static_cast<int>(queues.size());
+
+    for (int offset = 1; offset < numQueues; ++offset) {
+        auto& queue = *queues[static_cast<size_t>((worker + offset) % numQueues)];
+        std::lock_guard<std::mutex> lock(queue.lock);
+
+        if (queue.front != queue.back) {
+            task = queue.tasks[--queue.back];
+            numSteals++;
+            return true;
+        }
+    }
+
+    return false;
+}
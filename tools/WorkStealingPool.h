@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool for the batch tools. Each run deals task indices
+// round-robin onto one queue per worker, in the order given (so callers put the
+// largest tasks first). A worker takes from the front of its own queue and, once
+// that is empty, steals from the back of the others', so a few long files do not
+// leave the rest of the pool idle. Queues are preallocated per run and locked
+// only per take, which is negligible next to tasks of whole files or chunks.
+class WorkStealingPool
+{
+public:
+    // Worker 0 is the thread calling run(); numWorkers - 1 threads are started here
+    explicit WorkStealingPool(int numWorkers);
+    ~WorkStealingPool();
+
+    int getNumWorkers() const { return static_cast<int>(queues.size()); }
+
+    // Calls task(worker, index) once for every index in order, and returns when all
+    // have finished. Not reentrant; one run at a time.
+    void run(const std::vector<int>& order, const std::function<void(int worker, int task)>& task);
+
+    // Tasks taken from another worker's queue, over every run so far
+    long long getNumSteals() const { return numSteals.load(); }
+
+private:
+    struct Queue
+    {
+        std::mutex lock;
+        std::vector<int> tasks;
+        size_t front = 0;
+        size_t back = 0;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> threads;
+
+    std::mutex stateLock;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    const std::function<void(int, int)>* currentTask = nullptr;
+    unsigned long long generation = 0;
+    int workersBusy = 0;
+    bool quitting = false;
+
+    std::atomic<long long> numSteals { 0 };
+
+    void workerLoop(int worker);
+    void work(int worker);
+    bool takeOwn(int worker, int& task);
+    bool steal(int worker, int& task);
+};
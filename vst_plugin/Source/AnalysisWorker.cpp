@@ -0,0 +1,152 @@
+#include "AnalysisWorker.h"
+#include <cmath>
+#include <iostream>
+
+AnalysisWorker::AnalysisWorker()
+    : juce::Thread("Footstep Analysis")
+{
+}
+
+AnalysisWorker::~AnalysisWorker()
+{
+    stop();
+}
+
+void AnalysisWorker::prepare(double newSampleRate, int samplesPerBlock, const MLFootstepClassifier::Schedule& schedule)
+{
+    jassert(!isThreadRunning());
+    sampleRate = newSampleRate;
+
+    if (detector == nullptr) {
+        detector = std::make_unique<MLFootstepClassifier>();
+        detector->loadModel("");
+    }
+    detector->prepare(sampleRate, samplesPerBlock);
+    detector->setSchedule(schedule);
+    detector->setModel(activeModel.get());
+    expectedPosition = -1;
+
+    // Blocks that are not a multiple of the frame size leave partly filled frames,
+    // so allow for twice the frames the queue time needs
+    const int capacity = 2 * static_cast<int>(std::ceil(sampleRate * queueSeconds / frameSize)) + 1;
+    frames.resize(static_cast<size_t>(capacity));
+    frameFifo.setTotalSize(capacity);
+    eventFifo.reset();
+
+    analysedPosition.store(-1);
+    droppedSamples.store(0);
+}
+
+bool AnalysisWorker::start()
+{
+    if (isThreadRunning())
+        return true;
+
+    const auto options = juce::Thread::RealtimeOptions{}
+                             .withPriority(8)
+                             .withApproximateAudioProcessingTime(frameSize, sampleRate);
+
+    if (startRealtimeThread(options)) {
+        std::cout << "ANALYSIS WORKER: started with real-time priority" << std::endl;
+        return true;
+    }
+
+    const bool started = startThread(juce::Thread::Priority::highest);
+    std::cout << "ANALYSIS WORKER: " << (started ? "started at high priority (real-time not permitted)"
+                                                 : "failed to start") << std::endl;
+    return started;
+}
+
+void AnalysisWorker::stop()
+{
+    if (isThreadRunning())
+        stopThread(1000);
+}
+
+void AnalysisWorker::setModel(std::shared_ptr<const FootstepModel> model)
+{
+    const juce::SpinLock::ScopedLockType lock(modelLock);
+    if (model == requestedModel)
+        return;
+
+    requestedModel = std::move(model);
+    modelChanged.store(true, std::memory_order_release);
+}
+
+void AnalysisWorker::push(const float* analysis, int numSamples, juce::int64 position, float sensitivity)
+{
+    for (int done = 0; done < numSamples;) {
+        if (frameFifo.getFreeSpace() == 0) {
+            droppedSamples.fetch_add(numSamples - done, std::memory_order_relaxed);
+            return;
+        }
+
+        // The slot is handed to the worker when the scope ends, after it is filled
+        const auto scope = frameFifo.write(1);
+        auto& frame = frames[static_cast<size_t>(scope.startIndex1)];
+        frame.position = position + done;
+        frame.numSamples = juce::jmin(frameSize, numSamples - done);
+        frame.sensitivity = sensitivity;
+        std::copy(analysis + done, analysis + done + frame.numSamples, frame.samples);
+
+        done += frame.numSamples;
+    }
+}
+
+bool AnalysisWorker::popEvent(Event& event)
+{
+    if (eventFifo.getNumReady() == 0)
+        return false;
+
+    const auto scope = eventFifo.read(1);
+    event = events[static_cast<size_t>(scope.startIndex1)];
+    return true;
+}
+
+void AnalysisWorker::run()
+{
+    // The detector's envelopes decay into the denormal range in silence; the audio
+    // thread's flush-to-zero setting does not carry over to this one
+    juce::ScopedNoDenormals noDenormals;
+    
+    while (!threadShouldExit())
+    {
+        if (modelChanged.exchange(false, std::memory_order_acquire)) {
+            const juce::SpinLock::ScopedLockType lock(modelLock);
+            activeModel = requestedModel;
+            detector->setModel(activeModel.get());
+        }
+
+        // Nothing queued: poll again shortly. Polling keeps the audio side free of
+        // any wake-up call that could block.
+        if (frameFifo.getNumReady() == 0) {
+            wait(1);
+            continue;
+        }
+
+        while (frameFifo.getNumReady() > 0 && !threadShouldExit()) {
+            const auto scope = frameFifo.read(1);
+            analyse(frames[static_cast<size_t>(scope.startIndex1)]);
+        }
+    }
+}
+
+void AnalysisWorker::analyse(const Frame& frame)
+{
+    // Dropped samples or a restarted stream: the analysis window no longer holds
+    // contiguous audio
+    if (frame.position != expectedPosition)
+        detector->reset();
+
+    for (int i = 0; i < frame.numSamples; ++i) {
+        if (detector->detectFootstep(frame.samples[i], frame.sensitivity) && eventFifo.getFreeSpace() > 0) {
+            const auto scope = eventFifo.write(1);
+            events[static_cast<size_t>(scope.startIndex1)] = { frame.position + i, detector->getLastOnsetAge() };
+        }
+    }
+
+    expectedPosition = frame.position + frame.numSamples;
+
+    // Events are queued before the position that covers them is published
+    analysedPosition.store(expectedPosition, std::memory_order_release);
+}
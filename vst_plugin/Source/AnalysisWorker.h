@@ -0,0 +1,95 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include "MLFootstepClassifier.h"
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// BACKGROUND ANALYSIS: runs a footstep detector on its own real-time thread, so
+// heavy models (forest inference on MFCC windows) leave the audio callback.
+//
+// The audio thread pushes the analysis signal in frames stamped with their input
+// sample position through a juce::AbstractFifo; the worker feeds them to its own
+// MLFootstepClassifier and returns detections through a second lock-free FIFO,
+// each stamped with the input sample that triggered it. Both FIFOs have exactly
+// one reader and one writer, and nothing on the audio side locks or allocates.
+//
+// The worker publishes how far it has analysed, so the audio thread can tell
+// when it is running behind and fall back to a cheaper detector (see the
+// processor's latency budget).
+class AnalysisWorker : private juce::Thread
+{
+public:
+    struct Event
+    {
+        juce::int64 position;   // input sample that triggered the detection
+        int onsetAge;           // see MLFootstepClassifier::getLastOnsetAge
+    };
+
+    AnalysisWorker();
+    ~AnalysisWorker() override;
+
+    // Builds the detector and sizes the queues; the thread must be stopped
+    void prepare(double sampleRate, int samplesPerBlock, const MLFootstepClassifier::Schedule& schedule);
+
+    // Message thread. start() asks for real-time scheduling and falls back to
+    // the highest normal priority where that is not permitted.
+    bool start();
+    void stop();
+    bool isRunning() const { return isThreadRunning(); }
+
+    // Message thread: the worker picks the model up before its next frame and
+    // keeps its own reference, so replaced models stay alive while it finishes
+    void setModel(std::shared_ptr<const FootstepModel> model);
+
+    // Audio thread. Samples that do not fit are dropped (and counted); the
+    // position jump makes the worker restart its detector on the next frame.
+    void push(const float* analysis, int numSamples, juce::int64 position, float sensitivity);
+    bool popEvent(Event& event);
+
+    // Input position up to which every sample has been analysed and its events
+    // queued. Read it before popping events.
+    juce::int64 getAnalysedPosition() const { return analysedPosition.load(std::memory_order_acquire); }
+
+    juce::int64 getDroppedSamples() const { return droppedSamples.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr int frameSize = 64;
+    static constexpr double queueSeconds = 0.5;
+    static constexpr int eventCapacity = 64;
+
+    struct Frame
+    {
+        juce::int64 position;
+        int numSamples;
+        float sensitivity;
+        float samples[frameSize];
+    };
+
+    double sampleRate = 44100.0;
+
+    juce::AbstractFifo frameFifo { 1 };
+    std::vector<Frame> frames;
+
+    juce::AbstractFifo eventFifo { eventCapacity };
+    std::array<Event, eventCapacity> events {};
+
+    // Worker thread
+    std::unique_ptr<MLFootstepClassifier> detector;
+    std::shared_ptr<const FootstepModel> activeModel;
+    juce::int64 expectedPosition = -1;
+
+    juce::SpinLock modelLock;
+    std::shared_ptr<const FootstepModel> requestedModel;
+    std::atomic<bool> modelChanged { false };
+
+    std::atomic<juce::int64> analysedPosition { -1 };
+    std::atomic<juce::int64> droppedSamples { 0 };
+
+    void run() override;
+    void analyse(const Frame& frame);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AnalysisWorker)
+};
@@ -0,0 +1,86 @@
+#include "DegradeLadder.h"
+#include <cmath>
+
+void DegradeLadder::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+    reset();
+}
+
+void DegradeLadder::reset()
+{
+    steps = 0;
+    smoothedLoad = 0.0;
+    samplesSinceChange = 0;
+    holdSamples = static_cast<juce::int64>(sampleRate * holdSeconds);
+    lastChangeWasUp = false;
+}
+
+int DegradeLadder::update(double elapsedSeconds, int numSamples, int selectedLevel, juce::int64 position)
+{
+    steps = juce::jlimit(0, juce::jmax(0, selectedLevel), steps);
+
+    if (numSamples <= 0)
+        return getLevel(selectedLevel);
+
+    const double load = elapsedSeconds * sampleRate / numSamples;
+    const double coefficient = 1.0 - std::exp(-numSamples / (sampleRate * smoothingSeconds));
+    smoothedLoad += (load - smoothedLoad) * coefficient;
+    samplesSinceChange += numSamples;
+
+    lastLoad.store(static_cast<float>(load), std::memory_order_relaxed);
+    publishedSmoothedLoad.store(static_cast<float>(smoothedLoad), std::memory_order_relaxed);
+
+    const bool overloaded = load > overloadLoad;
+    if (overloaded)
+        numOverloads.fetch_add(1, std::memory_order_relaxed);
+
+    const bool settled = samplesSinceChange >= static_cast<juce::int64>(sampleRate * settleSeconds);
+
+    if (steps < selectedLevel && (overloaded || (settled && smoothedLoad > stepDownLoad)))
+    {
+        // The last step up did not hold: wait longer before trying again
+        if (lastChangeWasUp && samplesSinceChange < holdSamples)
+            holdSamples = std::min(holdSamples * 2, static_cast<juce::int64>(sampleRate * maxHoldSeconds));
+
+        step(+1, selectedLevel, position, load);
+    }
+    else if (steps > 0 && smoothedLoad < stepUpLoad && samplesSinceChange >= holdSamples)
+    {
+        // Held since the last step up: back to the normal hold
+        if (lastChangeWasUp)
+            holdSamples = static_cast<juce::int64>(sampleRate * holdSeconds);
+
+        step(-1, selectedLevel, position, load);
+    }
+
+    return getLevel(selectedLevel);
+}
+
+void DegradeLadder::step(int delta, int selectedLevel, juce::int64 position, double load)
+{
+    const int fromLevel = getLevel(selectedLevel);
+    steps += delta;
+
+    lastChangeWasUp = delta < 0;
+    samplesSinceChange = 0;
+    // The new level starts from a clean average; the hold and settle times cover the warm-up
+    smoothedLoad = 0.0;
+
+    numChanges.fetch_add(1, std::memory_order_relaxed);
+
+    if (changeFifo.getFreeSpace() > 0) {
+        const auto scope = changeFifo.write(1);
+        changes[static_cast<size_t>(scope.startIndex1)] = { position, fromLevel, getLevel(selectedLevel), static_cast<float>(load) };
+    }
+}
+
+bool DegradeLadder::popChange(Change& change)
+{
+    if (changeFifo.getNumReady() == 0)
+        return false;
+
+    const auto scope = changeFifo.read(1);
+    change = changes[static_cast<size_t>(scope.startIndex1)];
+    return true;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <atomic>
+
+// CPU GUARD: steps the detector down a ladder of cheaper levels when
+// processBlock runs short of headroom, and back up once it returns.
+//
+// Load = processing time of a block / its real-time length (numSamples /
+// sampleRate). One block above overloadLoad steps down at once (an xrun is
+// close); a smoothed load above stepDownLoad steps down after settling. A
+// step up needs the smoothed load under stepUpLoad for a hold period, which
+// doubles whenever a step up does not last (so a level that cannot keep up is
+// not retried every couple of seconds) and resets once one holds.
+//
+// Levels are numbered from the cheapest (0) up; the caller says which level
+// is selected and maps levels to detectors. Changes are queued for the
+// message thread as telemetry.
+class DegradeLadder
+{
+public:
+    struct Change
+    {
+        juce::int64 position;   // input sample where the new level starts
+        int fromLevel;
+        int toLevel;
+        float load;             // block load that caused it
+    };
+
+    // Counters and the change log survive prepare and reset
+    void prepare(double sampleRate);
+    void reset();
+
+    // Audio thread, after each block. Returns the level to run next.
+    int update(double elapsedSeconds, int numSamples, int selectedLevel, juce::int64 position);
+
+    int getLevel(int selectedLevel) const { return juce::jmax(0, selectedLevel - steps); }
+
+    // Telemetry: any thread for the counters, one reader for the change log
+    float getLoad() const { return lastLoad.load(std::memory_order_relaxed); }
+    float getSmoothedLoad() const { return publishedSmoothedLoad.load(std::memory_order_relaxed); }
+    juce::int64 getNumChanges() const { return numChanges.load(std::memory_order_relaxed); }
+    juce::int64 getNumOverloads() const { return numOverloads.load(std::memory_order_relaxed); }
+    bool popChange(Change& change);
+
+private:
+    static constexpr double overloadLoad = 0.8;
+    static constexpr double stepDownLoad = 0.5;
+    static constexpr double stepUpLoad = 0.2;
+    static constexpr double smoothingSeconds = 0.1;
+    static constexpr double settleSeconds = 0.05;
+    static constexpr double holdSeconds = 2.0;
+    static constexpr double maxHoldSeconds = 32.0;
+    static constexpr int changeCapacity = 32;
+
+    double sampleRate = 44100.0;
+
+    // Audio thread
+    int steps = 0;
+    double smoothedLoad = 0.0;
+    juce::int64 samplesSinceChange = 0;
+    juce::int64 holdSamples = 0;
+    bool lastChangeWasUp = false;
+
+    std::atomic<float> lastLoad { 0.0f };
+    std::atomic<float> publishedSmoothedLoad { 0.0f };
+    std::atomic<juce::int64> numChanges { 0 };
+    std::atomic<juce::int64> numOverloads { 0 };
+
+    juce::AbstractFifo changeFifo { changeCapacity };
+    std::array<Change, changeCapacity> changes {};
+
+    void step(int delta, int selectedLevel, juce::int64 position, double load);
+};
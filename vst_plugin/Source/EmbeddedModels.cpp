@@ -0,0 +1,27 @@
+#include "EmbeddedModels.h"
+#include "FootstepModelData.h"
+
+int EmbeddedModels::load(ModelRegistry& registry)
+{
+    int added = 0;
+
+    for (int i = 0; i < FootstepModelData::namedResourceListSize; ++i) {
+        int size = 0;
+        const char* data = FootstepModelData::getNamedResource(FootstepModelData::namedResourceList[i], size);
+        if (data != nullptr)
+            added += registry.loadFromMemory(FootstepModelData::originalFilenames[i], data, static_cast<size_t>(size));
+    }
+
+    return added;
+}
+
+juce::File EmbeddedModels::getOverrideDirectory()
+{
+    juce::String path = juce::SystemStats::getEnvironmentVariable("FOOTSTEP_DETECTOR_MODELS", {});
+    if (path.isNotEmpty())
+        return juce::File::getCurrentWorkingDirectory().getChildFile(path);
+
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+        .getChildFile("FootstepDetector")
+        .getChildFile("models");
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "ModelRegistry.h"
+
+// Model exports compiled into the plugin (juce_add_binary_data target
+// FootstepModelData), so instantiation needs no file I/O.
+namespace EmbeddedModels
+{
+    // Adds every embedded model to the registry; returns the number added
+    int load(ModelRegistry& registry);
+
+    // Optional on-disk models that override the embedded ones by source name:
+    // $FOOTSTEP_DETECTOR_MODELS if set, otherwise
+    // <user application data>/FootstepDetector/models
+    juce::File getOverrideDirectory();
+}
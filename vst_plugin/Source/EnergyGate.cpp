@@ -0,0 +1,52 @@
+#include "EnergyGate.h"
+#include <cmath>
+
+namespace
+{
+    constexpr double fastSeconds = 0.002;
+    constexpr double slowSeconds = 0.25;
+    constexpr double cooldownSeconds = 0.1;    // same as the classifier
+    constexpr float levelFloor = 0.01f;        // below this nothing counts as a step
+}
+
+void EnergyGate::prepare(double sampleRate)
+{
+    fastCoefficient = static_cast<float>(1.0 - std::exp(-1.0 / (sampleRate * fastSeconds)));
+    slowCoefficient = static_cast<float>(1.0 - std::exp(-1.0 / (sampleRate * slowSeconds)));
+    cooldownSamples = static_cast<int>(sampleRate * cooldownSeconds);
+    reset();
+}
+
+void EnergyGate::reset()
+{
+    fastEnvelope = 0.0f;
+    slowEnvelope = 0.0f;
+    riseLength = 0;
+    cooldownCounter = 0;
+    lastOnsetAge = 0;
+}
+
+bool EnergyGate::detectFootstep(float inputSample, float sensitivity)
+{
+    const float level = std::abs(inputSample);
+    fastEnvelope += (level - fastEnvelope) * fastCoefficient;
+    slowEnvelope += (level - slowEnvelope) * slowCoefficient;
+
+    riseLength = fastEnvelope > slowEnvelope ? riseLength + 1 : 0;
+
+    if (cooldownCounter > 0) {
+        cooldownCounter--;
+        return false;
+    }
+
+    // Sensitivity 0..1 maps to a required rise of 4x..1.5x over the background
+    const float ratio = 4.0f - 2.5f * sensitivity;
+
+    if (fastEnvelope > levelFloor && fastEnvelope > slowEnvelope * ratio) {
+        cooldownCounter = cooldownSamples;
+        lastOnsetAge = riseLength;
+        return true;
+    }
+
+    return false;
+}
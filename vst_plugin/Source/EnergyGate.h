@@ -0,0 +1,34 @@
+#pragma once
+
+// Cheapest footstep detector: an onset gate on the analysis signal. A fast
+// and a slow rectified envelope are tracked, and a footstep is reported when
+// the fast one rises well above the slow one (a transient over the running
+// background) while above an absolute floor. A few operations per sample and
+// no window, so it answers immediately; it cannot tell footsteps from other
+// transients, which is what the models are for.
+//
+// Same streaming interface as MLFootstepClassifier, so it can stand in for it.
+class EnergyGate
+{
+public:
+    void prepare(double sampleRate);
+    void reset();
+
+    bool detectFootstep(float inputSample, float sensitivity);
+
+    bool isInCooldown() const { return cooldownCounter > 0; }
+
+    // Samples since the fast envelope started rising above the slow one
+    int getLastOnsetAge() const { return lastOnsetAge; }
+
+private:
+    float fastCoefficient = 0.0f;
+    float slowCoefficient = 0.0f;
+    float fastEnvelope = 0.0f;
+    float slowEnvelope = 0.0f;
+
+    int riseLength = 0;
+    int cooldownSamples = 0;
+    int cooldownCounter = 0;
+    int lastOnsetAge = 0;
+};
@@ -0,0 +1,132 @@
+#include "FootstepEQ.h"
+#include <cfloat>
+#include <complex>
+
+namespace
+{
+    // Fitted (minimax on log magnitude, 20 Hz - 20 kHz) to the three-band cascade
+    constexpr float bandFrequency = 120.0f;
+    constexpr float bandQ = 0.15f;
+    constexpr float bandMix = 0.26f;
+    constexpr float outputCompensation = 0.85f;  // prevents buildup of the cumulative EQ gain
+}
+
+void FootstepEQ::prepare(double newSampleRate, int maximumBlockSize, int channels)
+{
+    sampleRate = newSampleRate;
+    band = juce::dsp::IIR::Coefficients<float>::makeBandPass(sampleRate, bandFrequency, bandQ);
+
+    const float* c = band->getRawCoefficients();  // b0 b1 b2 a1 a2
+    const float bandGain = outputCompensation * bandMix;
+
+    b0 = Vec::expand(c[0] * bandGain);
+    b1 = Vec::expand(c[1] * bandGain);
+    b2 = Vec::expand(c[2] * bandGain);
+    a1 = Vec::expand(c[3]);
+    a2 = Vec::expand(c[4]);
+    dryGain = Vec::expand(outputCompensation);
+
+    numChannels = juce::jmax(1, channels);
+    numGroups = (numChannels + static_cast<int>(Vec::size()) - 1) / static_cast<int>(Vec::size());
+
+    state.assign(static_cast<size_t>(numGroups * 2), Vec::expand(0.0f));
+
+    // Lanes without a channel stay zero for good
+    interleaved.assign(static_cast<size_t>(juce::jmax(1, maximumBlockSize)), Vec::expand(0.0f));
+}
+
+void FootstepEQ::reset()
+{
+    std::fill(state.begin(), state.end(), Vec::expand(0.0f));
+}
+
+void FootstepEQ::process(const juce::dsp::ProcessContextReplacing<float>& context)
+{
+    auto& block = context.getOutputBlock();
+    const size_t numSamples = juce::jmin(block.getNumSamples(), interleaved.size());
+    jassert(numSamples == block.getNumSamples());
+    jassert(static_cast<int>(block.getNumChannels()) <= numChannels);
+
+    for (int group = 0; group < numGroups; ++group)
+    {
+        interleave(block, group, numSamples);
+
+        Vec s1 = state[static_cast<size_t>(group * 2)];
+        Vec s2 = state[static_cast<size_t>(group * 2 + 1)];
+        Vec* samples = interleaved.data();
+
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            const Vec x = samples[i];
+            const Vec y = (b0 * x) + s1;
+            s1 = (b1 * x) - (a1 * y) + s2;
+            s2 = (b2 * x) - (a2 * y);
+
+            samples[i] = (dryGain * x) + y;
+        }
+
+        state[static_cast<size_t>(group * 2)] = s1;
+        state[static_cast<size_t>(group * 2 + 1)] = s2;
+
+        deinterleave(block, group, numSamples);
+    }
+}
+
+void FootstepEQ::flushDenormals()
+{
+    // The state decays towards zero after the input stops; without flush-to-zero
+    // it lingers in the denormal range, where each operation is many times slower
+    const Vec smallestNormal = Vec::expand(FLT_MIN);
+    for (auto& s : state)
+        s = s & Vec::greaterThanOrEqual(Vec::abs(s), smallestNormal);
+}
+
+double FootstepEQ::getMagnitudeForFrequency(double frequency) const
+{
+    if (band == nullptr)
+        return 1.0;
+
+    const auto bandResponse = std::polar(band->getMagnitudeForFrequency(frequency, sampleRate),
+                                         band->getPhaseForFrequency(frequency, sampleRate));
+
+    return std::abs(double(outputCompensation) * (1.0 + double(bandMix) * bandResponse));
+}
+
+void FootstepEQ::interleave(const juce::dsp::AudioBlock<float>& source, int group, size_t numSamples)
+{
+    const size_t lanes = Vec::size();
+    auto* lanesData = reinterpret_cast<float*>(interleaved.data());
+
+    for (size_t lane = 0; lane < lanes; ++lane) {
+        const size_t channel = static_cast<size_t>(group) * lanes + lane;
+        if (channel >= static_cast<size_t>(numChannels))
+            break;
+
+        // Prepared channel missing from this block: keep its lane silent
+        if (channel >= source.getNumChannels()) {
+            for (size_t i = 0; i < numSamples; ++i)
+                lanesData[i * lanes + lane] = 0.0f;
+            continue;
+        }
+
+        const float* input = source.getChannelPointer(channel);
+        for (size_t i = 0; i < numSamples; ++i)
+            lanesData[i * lanes + lane] = input[i];
+    }
+}
+
+void FootstepEQ::deinterleave(juce::dsp::AudioBlock<float>& destination, int group, size_t numSamples) const
+{
+    const size_t lanes = Vec::size();
+    const auto* lanesData = reinterpret_cast<const float*>(interleaved.data());
+
+    for (size_t lane = 0; lane < lanes; ++lane) {
+        const size_t channel = static_cast<size_t>(group) * lanes + lane;
+        if (channel >= destination.getNumChannels())
+            break;
+
+        float* output = destination.getChannelPointer(channel);
+        for (size_t i = 0; i < numSamples; ++i)
+            output[i] = lanesData[i * lanes + lane];
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+// Common interface for every model format the plugin can run.
+// All models consume the 78 raw MFCC statistics produced by MFCCExtractor
+// and return P(footstep) in [0, 1].
+class FootstepModel
+{
+public:
+    static constexpr int N_FEATURES = 78;
+
+    // CPU tiers, cheapest first
+    enum class Tier
+    {
+        SimplifiedRules = 0,
+        TopFeatures,
+        FullForest
+    };
+
+    static constexpr int NUM_TIERS = 3;
+
+    virtual ~FootstepModel() = default;
+
+    virtual float predictProbability(const float* rawFeatures) const = 0;
+    virtual Tier getTier() const = 0;
+
+    // Cost estimates for the model table (compares / multiply-adds per inference)
+    virtual int getOperationsPerInference() const = 0;
+    virtual size_t getModelBytes() const = 0;
+
+    const juce::String& getName() const { return name; }
+    void setName(const juce::String& newName) { name = newName; }
+
+    // Probability threshold suggested by the training export
+    float getDecisionThreshold() const { return decisionThreshold; }
+    void setDecisionThreshold(float newThreshold) { decisionThreshold = newThreshold; }
+
+    static juce::String getTierName(Tier tier)
+    {
+        switch (tier) {
+            case Tier::SimplifiedRules: return "Simplified Rules";
+            case Tier::TopFeatures:     return "Top-15 Features";
+            case Tier::FullForest:      return "Full Forest";
+        }
+        return {};
+    }
+
+protected:
+    juce::String name;
+    float decisionThreshold = 0.5f;
+};
@@ -1,21 +1,13 @@
 #include "MFCCExtractor.h"
+#include "SharedObjectCache.h"
 
 MFCCExtractor::MFCCExtractor() : fft(11) // 2048 point FFT
 {
     fftBuffer.resize(fft.getSize() * 2, 0.0f);
-    window.resize(WINDOW_SIZE);
     magnitudeSpectrum.resize(WINDOW_SIZE / 2 + 1);
     melEnergies.resize(N_MEL_FILTERS);
-    currentMFCC.resize(N_MFCC);
-    prevMFCC.resize(N_MFCC, 0.0f);
-    prevPrevMFCC.resize(N_MFCC, 0.0f);
-    mfccFrames.clear();
     
-    // Initialize Hann window
-    for (int i = 0; i < WINDOW_SIZE; ++i)
-    {
-        window[i] = 0.5f * (1.0f - std::cos(2.0f * juce::MathConstants<float>::pi * i / (WINDOW_SIZE - 1)));
-    }
+    // The analysis tables depend on the host rate: they are taken in prepare
 }
 
 MFCCExtractor::~MFCCExtractor() = default;
@@ -23,70 +15,73 @@ MFCCExtractor::~MFCCExtractor() = default;
 void MFCCExtractor::prepare(double sr)
 {
     sampleRate = sr;
-    initializeMelFilterBank();
-    initializeDCT();
+    tables = getSharedTables(sampleRate);
+    frameData.fill(0.0f);
+    numFrames = 0;
+}
+
+std::shared_ptr<const MFCCExtractor::Tables> MFCCExtractor::getSharedTables(double sampleRate)
+{
+    return SharedObjectCache<Tables>::getInstance().getOrCreate("mfcc@" + juce::String(sampleRate), [sampleRate]
+    {
+        auto newTables = std::make_shared<Tables>();
+        
+        // Hann window
+        newTables->window.resize(WINDOW_SIZE);
+        for (int i = 0; i < WINDOW_SIZE; ++i)
+        {
+            newTables->window[i] = 0.5f * (1.0f - std::cos(2.0f * juce::MathConstants<float>::pi * i / (WINDOW_SIZE - 1)));
+        }
+        
+        initializeMelFilterBank(*newTables, sampleRate);
+        initializeDCT(*newTables);
+        return newTables;
+    });
+}
+
+size_t MFCCExtractor::Tables::getBytes() const
+{
+    size_t bytes = window.size() * sizeof(float);
+    for (const auto& filter : melFilterBank)
+        bytes += filter.size() * sizeof(float);
+    for (const auto& row : dctMatrix)
+        bytes += row.size() * sizeof(float);
+    return bytes;
 }
 
 std::array<float, MFCCExtractor::N_FEATURES> MFCCExtractor::extractFeatures(const float* audioData, int numSamples)
 {
     std::array<float, N_FEATURES> features{};
     
-    // Clear previous frames
-    mfccFrames.clear();
+    jassert(tables != nullptr);    // prepare() first
+    if (tables == nullptr)
+        return features;
     
-    // CRITICAL FIX: Use smaller window size to get multiple frames from 2048 samples
-    const int SMALL_WINDOW = 512;  // Much smaller window
-    const int FRAME_HOP = 128;     // Small hop for overlap
+    // Clear previous frames
+    numFrames = 0;
     
-    // Process multiple overlapping frames with smaller windows
-    for (int frameStart = 0; frameStart <= numSamples - SMALL_WINDOW; frameStart += FRAME_HOP)
+    // Process multiple overlapping short frames, zero-padded to the FFT size
+    for (int frameStart = 0; frameStart <= numSamples - FRAME_SIZE && numFrames < MAX_FRAMES; frameStart += FRAME_HOP)
     {
-        // Create padded frame for FFT
-        std::vector<float> frameData(WINDOW_SIZE, 0.0f); // Pad to 2048 for FFT
-        
-        // Copy actual audio data
-        std::copy(audioData + frameStart, audioData + frameStart + SMALL_WINDOW, frameData.begin());
-        
-        // Process this frame
+        // Only the first FRAME_SIZE samples change: the padding stays zero
+        std::copy(audioData + frameStart, audioData + frameStart + FRAME_SIZE, frameData.begin());
         processSingleFrame(frameData.data());
-        
-        // Limit number of frames for consistent processing
-        if (mfccFrames.size() >= 10) break;
-    }
-    
-    // Debug: Verify we have multiple frames
-    static int debugCounter = 0;
-    if (++debugCounter % 50 == 0) {
-        std::cout << "🔧 MFCC Frames: " << mfccFrames.size() 
-                  << " from " << numSamples << " samples";
-        if (mfccFrames.size() >= 2) {
-            std::cout << ", First MFCC[0]=" << mfccFrames[0][0] 
-                      << ", Last MFCC[0]=" << mfccFrames.back()[0];
-        }
-        std::cout << std::endl;
     }
     
     // Ensure we have at least 2 frames for statistics
-    if (mfccFrames.size() < 2) {
-        // Generate synthetic variation if we don't have enough frames
-        if (mfccFrames.size() == 1) {
-            // Create a slightly modified version of the frame
-            std::vector<float> modifiedFrame = mfccFrames[0];
-            for (size_t i = 0; i < modifiedFrame.size(); ++i) {
-                modifiedFrame[i] += (i % 2 == 0 ? 0.1f : -0.1f); // Add small variation
-            }
-            mfccFrames.push_back(modifiedFrame);
-        } else {
-            // No frames at all - create default frames
-            std::vector<float> defaultFrame(N_MFCC, 0.0f);
-            mfccFrames.push_back(defaultFrame);
-            
-            std::vector<float> variantFrame(N_MFCC);
-            for (int i = 0; i < N_MFCC; ++i) {
-                variantFrame[i] = (i % 2 == 0 ? 1.0f : -1.0f);
-            }
-            mfccFrames.push_back(variantFrame);
+    if (numFrames == 1) {
+        // Create a slightly modified version of the frame
+        for (int i = 0; i < N_MFCC; ++i) {
+            mfccFrames[1][i] = mfccFrames[0][i] + (i % 2 == 0 ? 0.1f : -0.1f); // Add small variation
+        }
+        numFrames = 2;
+    } else if (numFrames == 0) {
+        // No frames at all - create default frames
+        mfccFrames[0].fill(0.0f);
+        for (int i = 0; i < N_MFCC; ++i) {
+            mfccFrames[1][i] = (i % 2 == 0 ? 1.0f : -1.0f);
         }
+        numFrames = 2;
     }
     
     // Compute statistics with guaranteed multiple frames
@@ -97,6 +92,13 @@ std::array<float, MFCCExtractor::N_FEATURES> MFCCExtractor::extractFeatures(cons
 
 void MFCCExtractor::processSingleFrame(const float* frameData)
 {
+    const auto& window = tables->window;
+    const auto& melFilterBank = tables->melFilterBank;
+    const auto& dctMatrix = tables->dctMatrix;
+    
+    jassert(numFrames < MAX_FRAMES);
+    auto& mfcc = mfccFrames[static_cast<size_t>(numFrames++)];
+    
     // Apply window to full 2048 samples (padded if necessary)
     for (int i = 0; i < WINDOW_SIZE; ++i)
     {
@@ -130,18 +132,15 @@ void MFCCExtractor::processSingleFrame(const float* frameData)
         melEnergies[m] = std::log(std::max(melEnergies[m], 1e-10f));
     }
     
-    // Apply DCT to get MFCC
+    // Apply DCT to get MFCC, stored as the next frame
     for (int i = 0; i < N_MFCC; ++i)
     {
-        currentMFCC[i] = 0.0f;
+        mfcc[i] = 0.0f;
         for (int j = 0; j < N_MEL_FILTERS; ++j)
         {
-            currentMFCC[i] += melEnergies[j] * dctMatrix[i][j];
+            mfcc[i] += melEnergies[j] * dctMatrix[i][j];
         }
     }
-    
-    // Store frame
-    mfccFrames.push_back(currentMFCC);
 }
 
 void MFCCExtractor::computeFeatureStatistics(std::array<float, N_FEATURES>& features)
@@ -149,42 +148,31 @@ void MFCCExtractor::computeFeatureStatistics(std::array<float, N_FEATURES>& feat
     // Initialize all features to zero
     features.fill(0.0f);
     
-    if (mfccFrames.empty()) {
+    if (numFrames == 0) {
         return;
     }
     
-    int numFrames = static_cast<int>(mfccFrames.size());
-    
     // CRITICAL: Process each MFCC coefficient
     for (int coeff = 0; coeff < N_MFCC; ++coeff)
     {
-        // Collect values for this coefficient across all frames
-        std::vector<float> coeffValues;
-        coeffValues.reserve(numFrames);
-        
-        for (const auto& frame : mfccFrames)
-        {
-            coeffValues.push_back(frame[coeff]);
-        }
-        
-        // Calculate basic statistics
+        // Calculate basic statistics across the frames
         float sum = 0.0f;
-        for (float val : coeffValues)
+        float min_val = mfccFrames[0][coeff];
+        float max_val = mfccFrames[0][coeff];
+        for (int frame = 0; frame < numFrames; ++frame)
         {
+            float val = mfccFrames[frame][coeff];
             sum += val;
+            min_val = std::min(min_val, val);
+            max_val = std::max(max_val, val);
         }
         float mean = sum / numFrames;
         
-        // Find min and max
-        auto minmax = std::minmax_element(coeffValues.begin(), coeffValues.end());
-        float min_val = *minmax.first;
-        float max_val = *minmax.second;
-        
         // CRITICAL: Calculate standard deviation correctly
         float sum_sq_diff = 0.0f;
-        for (float val : coeffValues)
+        for (int frame = 0; frame < numFrames; ++frame)
         {
-            float diff = val - mean;
+            float diff = mfccFrames[frame][coeff] - mean;
             sum_sq_diff += diff * diff;
         }
         
@@ -228,20 +216,11 @@ void MFCCExtractor::computeFeatureStatistics(std::array<float, N_FEATURES>& feat
         }
         features[baseIdx + 5] = delta2_mean; // mfcc_X_delta2_mean
     }
-    
-    // Debug: Verify statistics are working
-    static int debugCount = 0;
-    if (++debugCount % 50 == 0 && numFrames > 1) {
-        std::cout << "🔧 Stats Verification: Frames=" << numFrames 
-                  << ", MFCC0: mean=" << features[0] 
-                  << ", std=" << features[1] 
-                  << ", max=" << features[2] 
-                  << ", min=" << features[3] << std::endl;
-    }
 }
 
-void MFCCExtractor::initializeMelFilterBank()
+void MFCCExtractor::initializeMelFilterBank(Tables& tables, double sampleRate)
 {
+    auto& melFilterBank = tables.melFilterBank;
     melFilterBank.resize(N_MEL_FILTERS);
     
     float mel_low = melScale(80.0f);
@@ -283,8 +262,9 @@ void MFCCExtractor::initializeMelFilterBank()
     }
 }
 
-void MFCCExtractor::initializeDCT()
+void MFCCExtractor::initializeDCT(Tables& tables)
 {
+    auto& dctMatrix = tables.dctMatrix;
     dctMatrix.resize(N_MFCC);
     for (int i = 0; i < N_MFCC; ++i)
     {
@@ -4,6 +4,7 @@
 #include <vector>
 #include <array>
 #include <cmath>
+#include <memory>
 
 class MFCCExtractor
 {
@@ -14,39 +15,54 @@ public:
     static constexpr int HOP_SIZE = 512;
     static constexpr int N_MEL_FILTERS = 40;
     
+    // extractFeatures analyses up to MAX_FRAMES short frames, each zero-padded to WINDOW_SIZE
+    static constexpr int FRAME_SIZE = 512;
+    static constexpr int FRAME_HOP = 128;
+    static constexpr int MAX_FRAMES = 10;
+    
     MFCCExtractor();
     ~MFCCExtractor();
     
+    // Takes the shared tables for the rate; extractFeatures returns zeros before it.
+    // extractFeatures neither allocates nor logs: it runs on the audio thread.
     void prepare(double sampleRate);
     std::array<float, N_FEATURES> extractFeatures(const float* audioData, int numSamples);
     
+    // Read-only analysis tables, shared by every extractor running at the same sample rate
+    struct Tables
+    {
+        std::vector<float> window;                          // Hann window
+        std::vector<std::vector<float>> melFilterBank;      // N_MEL_FILTERS x (WINDOW_SIZE / 2 + 1)
+        std::vector<std::vector<float>> dctMatrix;          // N_MFCC x N_MEL_FILTERS
+        
+        size_t getBytes() const;
+    };
+    
+    static std::shared_ptr<const Tables> getSharedTables(double sampleRate);
+    
 private:
+    friend class StageBenchmark;    // tools/StageBenchmark.cpp times processSingleFrame
+    
     double sampleRate = 44100.0;
     
-    // FFT processing
+    // FFT processing (per instance: the FFT engine serialises concurrent calls)
     juce::dsp::FFT fft;
     std::vector<float> fftBuffer;
-    std::vector<float> window;
     std::vector<float> magnitudeSpectrum;
     
-    // Mel filter bank
-    std::vector<std::vector<float>> melFilterBank;
+    std::shared_ptr<const Tables> tables;               // null until prepare
     std::vector<float> melEnergies;
     
-    // DCT matrix for MFCC computation
-    std::vector<std::vector<float>> dctMatrix;
-    
     // Feature computation buffers
-    std::vector<std::vector<float>> mfccFrames;
-    std::vector<float> currentMFCC;
-    std::vector<float> prevMFCC;
-    std::vector<float> prevPrevMFCC;
+    std::array<float, WINDOW_SIZE> frameData {};        // one frame, zero past FRAME_SIZE
+    std::array<std::array<float, N_MFCC>, MAX_FRAMES> mfccFrames {};
+    int numFrames = 0;
     
     // Helper methods
-    void initializeMelFilterBank();
-    void initializeDCT();
-    void processSingleFrame(const float* frameData);  // NEW METHOD
+    static void initializeMelFilterBank(Tables& tables, double sampleRate);
+    static void initializeDCT(Tables& tables);
+    void processSingleFrame(const float* frameData);    // appends to mfccFrames
     void computeFeatureStatistics(std::array<float, N_FEATURES>& features);
-    float melScale(float frequency);
-    float invMelScale(float mel);
+    static float melScale(float frequency);
+    static float invMelScale(float mel);
 };
\ No newline at end of file
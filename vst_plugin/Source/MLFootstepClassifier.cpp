@@ -1,12 +1,27 @@
 #include "MLFootstepClassifier.h"
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <iostream>
 #include <iomanip>
 
+namespace
+{
+    // Activity tracking for the adaptive hop
+    constexpr double fastActivitySeconds = 0.005;
+    constexpr double slowActivitySeconds = 0.2;
+    constexpr float onsetRiseRatio = 1.5f;     // fast over slow envelope that counts as a rising onset
+    constexpr float silenceLevel = 0.001f;     // below this nothing counts as rising
+    
+    // Plausibility filters on the window's RMS and spectral centroid estimate
+    bool energyInRange(float energy) { return energy >= 0.001f && energy <= 0.8f; }
+    bool centroidInRange(float centroid) { return centroid <= 8000.0f; }
+}
+
 MLFootstepClassifier::MLFootstepClassifier()
 {
     audioBuffer.resize(BUFFER_SIZE, 0.0f);
+    analysisWindow.resize(BUFFER_SIZE, 0.0f);
     
     // FIXED: Realistic model weights based on footstep characteristics
     // Focus on low-frequency energy (footstep fundamentals are 50-300Hz)
@@ -54,6 +69,12 @@ bool MLFootstepClassifier::loadModel(const std::string& modelPath)
     std::cout << "Loading simplified ML model (pre-trained weights)" << std::endl;
     
     // Check if model file exists (for logging purposes)
+    if (modelPath.empty()) {
+        std::cout << "No model file given, using pre-trained weights" << std::endl;
+        modelLoaded = true;
+        return true;
+    }
+    
     std::ifstream file(modelPath);
     if (file.good()) {
         std::cout << "Model file found: " << modelPath << std::endl;
@@ -70,11 +91,35 @@ bool MLFootstepClassifier::loadModel(const std::string& modelPath)
 void MLFootstepClassifier::prepare(double sampleRate, int samplesPerBlock)
 {
     currentSampleRate = sampleRate;
+    fastActivityCoefficient = static_cast<float>(1.0 - std::exp(-1.0 / (sampleRate * fastActivitySeconds)));
+    slowActivityCoefficient = static_cast<float>(1.0 - std::exp(-1.0 / (sampleRate * slowActivitySeconds)));
+    reset();
+    mfccExtractor.prepare(sampleRate);
+    
+    std::cout << "Simplified ML classifier prepared for " << sampleRate << " Hz" << std::endl;
+}
+
+void MLFootstepClassifier::reset()
+{
     std::fill(audioBuffer.begin(), audioBuffer.end(), 0.0f);
     bufferPos = 0;
     cooldownCounter = 0;
-    
-    std::cout << "Simplified ML classifier prepared for " << sampleRate << " Hz" << std::endl;
+    lastOnsetAge = 0;
+    processingCounter = 0;
+    currentHop = schedule.minHop;
+    fastActivity = 0.0f;
+    slowActivity = 0.0f;
+}
+
+void MLFootstepClassifier::setSchedule(const Schedule& newSchedule)
+{
+    schedule = newSchedule;
+    schedule.minHop = std::max(1, schedule.minHop);
+    schedule.maxHop = std::max(schedule.minHop, schedule.maxHop);
+    schedule.modelMinHop = std::max(1, schedule.modelMinHop);
+    schedule.modelMaxHop = std::max(schedule.modelMinHop, schedule.modelMaxHop);
+    schedule.holdOffSamples = std::max(0, schedule.holdOffSamples);
+    currentHop = schedule.minHop;
 }
 
 bool MLFootstepClassifier::detectFootstep(float inputSample, float sensitivity)
@@ -83,47 +128,55 @@ bool MLFootstepClassifier::detectFootstep(float inputSample, float sensitivity)
     audioBuffer[bufferPos] = inputSample;
     bufferPos = (bufferPos + 1) % BUFFER_SIZE;
     
-    // FIXED: Process every 64 samples for much faster response (~1.5ms at 44.1kHz)
+    // ADAPTIVE HOP: a few operations per sample decide whether a decision is due
+    const float level = std::abs(inputSample);
+    fastActivity += (level - fastActivity) * fastActivityCoefficient;
+    slowActivity += (level - slowActivity) * slowActivityCoefficient;
     processingCounter++;
     
-    if (processingCounter < 64) {
-        if (cooldownCounter > 0) {
-            cooldownCounter--;
-            return false;
-        }
+    // No inference during the cooldown and hold-off
+    if (cooldownCounter > 0) {
+        cooldownCounter--;
         return false;
     }
     
+    const bool modelPath = activeModel != nullptr;
+    const int minHop = modelPath ? schedule.modelMinHop : schedule.minHop;
+    const int maxHop = modelPath ? schedule.modelMaxHop : schedule.maxHop;
+    const bool rising = fastActivity > silenceLevel && fastActivity > slowActivity * onsetRiseRatio;
+    
+    if (processingCounter < (rising ? minHop : juce::jlimit(minHop, maxHop, currentHop)))
+        return false;
+    
+    // Short hop while onset energy rises; otherwise each decision doubles the wait
+    currentHop = rising ? minHop : std::min(maxHop, std::max(minHop, currentHop) * 2);
     processingCounter = 0;
+    numInferences++;
     
     // DEBUG: More frequent processing confirmation
-    static int mlProcessingCount = 0;
     mlProcessingCount++;
-    if (mlProcessingCount % 50 == 0) {  // Every 50 ML processing cycles (~3.2 seconds)
-        std::cout << "ML processing cycle #" << mlProcessingCount << " | Buffer size: " << BUFFER_SIZE << std::endl;
-    }
-    
-    if (cooldownCounter > 0) {
-        cooldownCounter--;
-        return false;
+    if (mlProcessingCount % 50 == 0) {  // Every 50 ML processing cycles
+        std::cout << "ML processing cycle #" << mlProcessingCount << " | Buffer size: " << BUFFER_SIZE
+                  << " | Hop: " << currentHop << std::endl;
     }
     
     // Extract features from current buffer
     std::vector<float> features(FEATURE_SIZE);
     extractFeatures(audioBuffer.data(), BUFFER_SIZE, features.data());
     
-    // Run simplified ML inference
-    float confidence = runSimpleInference(features.data());
-    lastConfidence = confidence;
+    float confidence = 0.0f;
+    float threshold = 0.5f;
     
-    // FIXED: Much more reasonable threshold mapping
-    // sensitivity = 1.0 (max) → threshold = 0.1 (very sensitive)
-    // sensitivity = 0.0 (min) → threshold = 0.7 (conservative)
-    float threshold = 0.7f - (sensitivity * 0.6f); // 0.1 to 0.7 range
+    if (activeModel != nullptr) {
+        confidence = runModelInference();
+    } else {
+        // Run simplified ML inference
+        confidence = runSimpleInference(features.data());
+    }
+    threshold = getThreshold(sensitivity);
+    lastConfidence = confidence;
     
     // DEBUG: Track sensitivity changes and show current values
-    static float lastSensitivity = -1.0f;
-    static int debugCount = 0;
     debugCount++;
     
     if (std::abs(sensitivity - lastSensitivity) > 0.01f || debugCount % 100 == 0) {
@@ -141,13 +194,13 @@ bool MLFootstepClassifier::detectFootstep(float inputSample, float sensitivity)
         lastEnergy = currentEnergy;
         
         // Only filter out extreme cases
-        if (currentEnergy > 0.8f || currentEnergy < 0.001f) {  // Was too restrictive
+        if (!energyInRange(currentEnergy)) {  // Was too restrictive
             isFootstep = false;
             std::cout << "Energy filter rejected: " << currentEnergy << " (too extreme)" << std::endl;
         }
         
         // Only filter out very high noise
-        if (features[26] > 8000.0f) {  // Was too restrictive
+        if (!centroidInRange(features[26])) {  // Was too restrictive
             isFootstep = false;
             std::cout << "Frequency filter rejected: " << features[26] << "Hz (too high)" << std::endl;
         }
@@ -163,7 +216,9 @@ bool MLFootstepClassifier::detectFootstep(float inputSample, float sensitivity)
     }
     
     if (isFootstep) {
-        cooldownCounter = static_cast<int>(currentSampleRate * 0.1); // 100ms cooldown (shorter)
+        cooldownCounter = std::max(static_cast<int>(currentSampleRate * 0.1), schedule.holdOffSamples); // 100ms cooldown (shorter)
+        linearizeWindow();
+        lastOnsetAge = estimateOnsetAge(analysisWindow.data());
         totalDetections++;
         
         std::cout << "*** ML FOOTSTEP DETECTED! ***" << std::endl;
@@ -182,7 +237,102 @@ bool MLFootstepClassifier::detectFootstep(float inputSample, float sensitivity)
     return isFootstep;
 }
 
-void MLFootstepClassifier::extractFeatures(const float* audio, int length, float* features)
+MLFootstepClassifier::Decision MLFootstepClassifier::decide(const float* window, float sensitivity, Scratch& scratch) const
+{
+    Decision decision;
+    float* features = scratch.features.data();
+    extractFeatures(window, WINDOW_SIZE, features);
+    decision.threshold = getThreshold(sensitivity);
+    
+    // Windows the filters reject need no inference (silence, mostly)
+    if (!energyInRange(features[24]) || !centroidInRange(features[26]))
+        return decision;
+    
+    if (activeModel != nullptr) {
+        decision.confidence = modelConfidence(window, scratch.mfcc);
+    } else {
+        float activation = 0.0f;
+        decision.confidence = simpleConfidence(features, activation);
+    }
+    
+    decision.footstep = decision.confidence > decision.threshold;
+    if (decision.footstep)
+        decision.onsetAge = estimateOnsetAge(window);
+    
+    return decision;
+}
+
+float MLFootstepClassifier::getThreshold(float sensitivity) const
+{
+    // Registry model: sensitivity shifts the exported threshold by up to +/-0.3
+    if (activeModel != nullptr)
+        return juce::jlimit(0.05f, 0.95f, activeModel->getDecisionThreshold() + (0.5f - sensitivity) * 0.6f);
+    
+    // FIXED: Much more reasonable threshold mapping
+    // sensitivity = 1.0 (max) → threshold = 0.1 (very sensitive)
+    // sensitivity = 0.0 (min) → threshold = 0.7 (conservative)
+    return 0.7f - (sensitivity * 0.6f); // 0.1 to 0.7 range
+}
+
+void MLFootstepClassifier::linearizeWindow()
+{
+    // Unroll the ring buffer oldest-first so MFCC frames are in time order
+    std::copy(audioBuffer.begin() + bufferPos, audioBuffer.end(), analysisWindow.begin());
+    std::copy(audioBuffer.begin(), audioBuffer.begin() + bufferPos, analysisWindow.begin() + (BUFFER_SIZE - bufferPos));
+}
+
+float MLFootstepClassifier::runModelInference()
+{
+    linearizeWindow();
+    return modelConfidence(analysisWindow.data(), mfccExtractor);
+}
+
+float MLFootstepClassifier::modelConfidence(const float* window, MFCCExtractor& extractor) const
+{
+    auto features = extractor.extractFeatures(window, WINDOW_SIZE);
+    return juce::jlimit(0.0f, 1.0f, activeModel->predictProbability(features.data()));
+}
+
+int MLFootstepClassifier::estimateOnsetAge(const float* window)
+{
+    // Attack = the 32-sample frame whose energy rises most above the four frames
+    // before it, refined to the first sample reaching 30% of that frame's peak
+    constexpr int FRAME_SIZE = 32;
+    constexpr int NUM_FRAMES = BUFFER_SIZE / FRAME_SIZE;
+    
+    auto sampleAt = [window](int index) { return window[index]; };  // 0 = oldest
+    
+    std::array<float, NUM_FRAMES> energy{};
+    for (int frame = 0; frame < NUM_FRAMES; ++frame)
+        for (int i = frame * FRAME_SIZE; i < (frame + 1) * FRAME_SIZE; ++i)
+            energy[frame] += sampleAt(i) * sampleAt(i);
+    
+    int onsetFrame = NUM_FRAMES - 1;
+    float largestRise = 0.0f;
+    for (int frame = 4; frame < NUM_FRAMES; ++frame) {
+        float background = (energy[frame - 1] + energy[frame - 2] + energy[frame - 3] + energy[frame - 4]) * 0.25f;
+        if (energy[frame] - background > largestRise) {
+            largestRise = energy[frame] - background;
+            onsetFrame = frame;
+        }
+    }
+    
+    float peak = 0.0f;
+    for (int i = onsetFrame * FRAME_SIZE; i < (onsetFrame + 1) * FRAME_SIZE; ++i)
+        peak = std::max(peak, std::abs(sampleAt(i)));
+    
+    int onset = onsetFrame * FRAME_SIZE;
+    for (int i = (onsetFrame - 1) * FRAME_SIZE; i < (onsetFrame + 1) * FRAME_SIZE; ++i) {
+        if (i >= 0 && std::abs(sampleAt(i)) >= 0.3f * peak) {
+            onset = i;
+            break;
+        }
+    }
+    
+    return BUFFER_SIZE - 1 - onset;
+}
+
+void MLFootstepClassifier::extractFeatures(const float* audio, int length, float* features) const
 {
     // Extract 32 features that approximate your trained CNN
     if (length < 32) {
@@ -230,8 +380,42 @@ float MLFootstepClassifier::runSimpleInference(const float* features)
         return 0.0f;
     }
     
+    float activation = 0.0f;
+    const float confidence = simpleConfidence(features, activation);
+    
+    // DEBUG: Enhanced model debugging
+    sanityCheckCounter++;
+    totalActivation += activation;
+    totalConfidence += confidence;
+    maxActivation = std::max(maxActivation, activation);
+    minActivation = std::min(minActivation, activation);
+    
+    if (sanityCheckCounter % 100 == 0) {
+        float avgActivation = totalActivation / 100.0f;
+        float avgConfidence = totalConfidence / 100.0f;
+        std::cout << "MODEL HEALTH CHECK:" << std::endl;
+        std::cout << "   Avg Activation: " << avgActivation << " | Avg Confidence: " << avgConfidence << std::endl;
+        std::cout << "   Range: " << minActivation << " to " << maxActivation << std::endl;
+        std::cout << "   Current: " << activation << " -> " << confidence << std::endl;
+        
+        totalActivation = 0.0f;
+        totalConfidence = 0.0f;
+        maxActivation = -1000.0f;
+        minActivation = 1000.0f;
+    }
+    
+    return confidence;
+}
+
+float MLFootstepClassifier::simpleConfidence(const float* features, float& activation) const
+{
+    activation = 0.0f;
+    if (!modelLoaded || modelWeights.size() != FEATURE_SIZE) {
+        return 0.0f;
+    }
+    
     // FIXED: More appropriate feature normalization for footstep detection
-    std::vector<float> normalizedFeatures(FEATURE_SIZE);
+    std::array<float, FEATURE_SIZE> normalizedFeatures {};
     
     // Normalize features to ranges that make sense for the model
     for (int i = 0; i < FEATURE_SIZE; i++) {
@@ -265,7 +449,7 @@ float MLFootstepClassifier::runSimpleInference(const float* features)
     }
     
     // Linear model inference
-    float activation = modelBias[0];
+    activation = modelBias[0];
     
     for (int i = 0; i < FEATURE_SIZE; i++) {
         activation += normalizedFeatures[i] * modelWeights[i];
@@ -273,38 +457,10 @@ float MLFootstepClassifier::runSimpleInference(const float* features)
     
     // Sigmoid activation for binary classification
     float confidence = 1.0f / (1.0f + std::exp(-activation));
-    
-    // DEBUG: Enhanced model debugging
-    static int sanityCheckCounter = 0;
-    static float totalActivation = 0.0f;
-    static float totalConfidence = 0.0f;
-    static float maxActivation = -1000.0f;
-    static float minActivation = 1000.0f;
-    
-    sanityCheckCounter++;
-    totalActivation += activation;
-    totalConfidence += confidence;
-    maxActivation = std::max(maxActivation, activation);
-    minActivation = std::min(minActivation, activation);
-    
-    if (sanityCheckCounter % 100 == 0) {
-        float avgActivation = totalActivation / 100.0f;
-        float avgConfidence = totalConfidence / 100.0f;
-        std::cout << "MODEL HEALTH CHECK:" << std::endl;
-        std::cout << "   Avg Activation: " << avgActivation << " | Avg Confidence: " << avgConfidence << std::endl;
-        std::cout << "   Range: " << minActivation << " to " << maxActivation << std::endl;
-        std::cout << "   Current: " << activation << " -> " << confidence << std::endl;
-        
-        totalActivation = 0.0f;
-        totalConfidence = 0.0f;
-        maxActivation = -1000.0f;
-        minActivation = 1000.0f;
-    }
-    
     return std::max(0.0f, std::min(1.0f, confidence));
 }
 
-float MLFootstepClassifier::calculateRMS(const float* audio, int length)
+float MLFootstepClassifier::calculateRMS(const float* audio, int length) const
 {
     if (length <= 0) return 0.0f;
     
@@ -315,7 +471,7 @@ float MLFootstepClassifier::calculateRMS(const float* audio, int length)
     return std::sqrt(sum / length);
 }
 
-float MLFootstepClassifier::calculateSpectralCentroid(const float* audio, int length)
+float MLFootstepClassifier::calculateSpectralCentroid(const float* audio, int length) const
 {
     if (length <= 2) return 1000.0f;
     
@@ -361,7 +517,7 @@ float MLFootstepClassifier::calculateSpectralCentroid(const float* audio, int le
     return std::max(100.0f, std::min(8000.0f, estimatedCentroid));
 }
 
-float MLFootstepClassifier::calculateZeroCrossingRate(const float* audio, int length)
+float MLFootstepClassifier::calculateZeroCrossingRate(const float* audio, int length) const
 {
     if (length <= 1) return 0.0f;
     
@@ -387,6 +543,7 @@ void MLFootstepClassifier::printDebugStats() const
     std::cout << "║ Last energy: " << std::setw(29) << std::fixed << std::setprecision(4) << lastEnergy << " ║" << std::endl;
     std::cout << "║ Current cooldown: " << std::setw(24) << cooldownCounter << " ║" << std::endl;
     std::cout << "║ Model loaded: " << std::setw(28) << (modelLoaded ? "Yes" : "No") << " ║" << std::endl;
+    std::cout << "║ Active model: " << std::setw(28) << (activeModel ? FootstepModel::getTierName(activeModel->getTier()).toStdString() : "Built-in") << " ║" << std::endl;
     std::cout << "║ Test mode: " << std::setw(31) << (testMode ? "Enabled" : "Disabled") << " ║" << std::endl;
     std::cout << "║ Sample rate: " << std::setw(27) << currentSampleRate << " Hz ║" << std::endl;
     std::cout << "║ Buffer position: " << std::setw(25) << bufferPos << "/" << BUFFER_SIZE << " ║" << std::endl;
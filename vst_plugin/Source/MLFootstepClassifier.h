@@ -1,9 +1,12 @@
 #pragma once
 
+#include <array>
 #include <vector>
 #include <memory>
 #include <string>
 #include <fstream>
+#include "FootstepModel.h"
+#include "MFCCExtractor.h"
 
 // Simplified ML classifier without TensorFlow Lite dependencies
 class MLFootstepClassifier
@@ -15,25 +18,81 @@ public:
     // Initialize ML model
     bool loadModel(const std::string& modelPath);
     void prepare(double sampleRate, int samplesPerBlock);
+    void reset();  // clears streaming state, keeps sample rate and tables
     
     // Main detection method (replaces FootstepClassifier)
     bool detectFootstep(float inputSample, float sensitivity);
     
+    // Registry model (MFCC features). nullptr = built-in linear weights.
+    // Non-owning and allocation-free, so it can be swapped between audio blocks;
+    // the analysis buffer, cooldown and MFCC state carry over unchanged.
+    void setModel(const FootstepModel* model) { activeModel = model; }
+    const FootstepModel* getModel() const { return activeModel; }
+    
     // Compatibility methods
     float getLastConfidence() const { return lastConfidence; }
     float getLastEnergy() const { return lastEnergy; }
     float getBackgroundNoise() const { return 0.015f; }
     bool isInCooldown() const { return cooldownCounter > 0; }
     
+    // Samples between the estimated attack of the last detected footstep and the
+    // sample that triggered the detection. Decisions are taken once per hop on a
+    // whole analysis window, so the attack is usually well in the past by then.
+    int getLastOnsetAge() const { return lastOnsetAge; }
+    
+    // Inference scheduling. The hop between decisions follows activity: the shortest
+    // while onset energy rises, doubling per decision up to the longest in silence or
+    // steady ambience. Nothing is analysed during the cooldown or the hold-off after a
+    // detection. Registry models need a full MFCC pass per decision, so they have
+    // their own range. Equal min and max hops give a fixed cadence.
+    struct Schedule
+    {
+        int minHop = 64;
+        int maxHop = 512;
+        int modelMinHop = 256;
+        int modelMaxHop = 1024;
+        int holdOffSamples = 0;     // after a detection; the 100 ms cooldown applies at least
+    };
+    
+    void setSchedule(const Schedule& newSchedule);
+    const Schedule& getSchedule() const { return schedule; }
+    
+    // Decisions analysed since construction (for cost reports)
+    long long getNumInferences() const { return numInferences; }
+    
+    // One decision on a whole window, oldest sample first, with the current model and
+    // without touching the streaming state (no hop, cooldown or debug output). Scores
+    // depend only on the window, so the OFFLINE path can take many of them on several
+    // threads at once, each with its own scratch.
+    static constexpr int WINDOW_SIZE = 2048;
+    
+    struct Decision
+    {
+        bool footstep = false;
+        float confidence = 0.0f;
+        float threshold = 0.5f;
+        int onsetAge = 0;           // set for footsteps only
+    };
+    
+    struct Scratch
+    {
+        std::array<float, 32> features {};
+        MFCCExtractor mfcc;
+    };
+    
+    Decision decide(const float* window, float sensitivity, Scratch& scratch) const;
+    
     // Debug methods
     void printDebugStats() const;
     void resetDebugStats();
     void enableTestMode(bool enable) { testMode = enable; }
     
 private:
+    friend class StageBenchmark;    // tools/StageBenchmark.cpp times the stages below
+    
     // Audio processing parameters
-    static constexpr int BUFFER_SIZE = 2048;  // Smaller buffer for real-time
-    static constexpr int FEATURE_SIZE = 32;   // Simplified features
+    static constexpr int BUFFER_SIZE = WINDOW_SIZE;  // Smaller buffer for real-time
+    static constexpr int FEATURE_SIZE = 32;          // Simplified features
     
     // Audio buffer for feature extraction
     std::vector<float> audioBuffer;
@@ -43,25 +102,57 @@ private:
     float lastConfidence = 0.0f;
     float lastEnergy = 0.0f;
     int cooldownCounter = 0;
-    int processingCounter = 0;  // Move from static to instance variable
+    int lastOnsetAge = 0;
+    int processingCounter = 0;  // samples since the last decision
     double currentSampleRate = 44100.0;
     
+    // Adaptive hop: rectified activity envelopes, updated every sample
+    Schedule schedule;
+    int currentHop = 64;
+    float fastActivity = 0.0f;
+    float slowActivity = 0.0f;
+    float fastActivityCoefficient = 0.0f;
+    float slowActivityCoefficient = 0.0f;
+    long long numInferences = 0;
+    
     // ML model weights (simplified - pre-computed from your trained model)
     std::vector<float> modelWeights;
     std::vector<float> modelBias;
     bool modelLoaded = false;
     
-    // Debug counters
+    // Registry model path: MFCC statistics over the linearized analysis window
+    const FootstepModel* activeModel = nullptr;
+    MFCCExtractor mfccExtractor;
+    std::vector<float> analysisWindow;
+    
+    // Debug counters, per instance: classifiers run on several threads (batch
+    // workers, one analysis worker per speaker group)
     int totalDetections = 0;
     int falsePositiveCounter = 0;
     bool testMode = false;
+    int mlProcessingCount = 0;
+    int debugCount = 0;
+    float lastSensitivity = -1.0f;
+    
+    // Model health check over the last 100 simple inferences
+    int sanityCheckCounter = 0;
+    float totalActivation = 0.0f;
+    float totalConfidence = 0.0f;
+    float maxActivation = -1000.0f;
+    float minActivation = 1000.0f;
     
     // Feature extraction
-    void extractFeatures(const float* audio, int length, float* features);
+    void extractFeatures(const float* audio, int length, float* features) const;
     float runSimpleInference(const float* features);
+    float runModelInference();
+    float simpleConfidence(const float* features, float& activation) const;
+    float modelConfidence(const float* window, MFCCExtractor& extractor) const;
+    float getThreshold(float sensitivity) const;
+    void linearizeWindow();
+    static int estimateOnsetAge(const float* window);
     
     // Utility methods
-    float calculateRMS(const float* audio, int length);
-    float calculateSpectralCentroid(const float* audio, int length);
-    float calculateZeroCrossingRate(const float* audio, int length);
+    float calculateRMS(const float* audio, int length) const;
+    float calculateSpectralCentroid(const float* audio, int length) const;
+    float calculateZeroCrossingRate(const float* audio, int length) const;
 };
\ No newline at end of file
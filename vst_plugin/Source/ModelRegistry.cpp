@@ -0,0 +1,445 @@
+#include "ModelRegistry.h"
+#include "RandomForestModel.h"
+#include "RuleFootstepModel.h"
+#include "SharedObjectCache.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    using FeatureArray = std::array<float, FootstepModel::N_FEATURES>;
+
+    // Shipped exports in preference order: the first three share the scaler of
+    // the MFCCExtractor training run, the ESC50 exports use a different one
+    const char* const knownModelFiles[] = {
+        "footstep_model_cpp.json",
+        "enhanced_footstep_model.json",
+        "footstep_model_simple.json",
+        "professional_footstep_model.json",
+        "production_footstep_model.json"
+    };
+
+    bool readFeatureArray(const juce::var& value, FeatureArray& out)
+    {
+        auto* array = value.getArray();
+        if (array == nullptr || array->size() != FootstepModel::N_FEATURES)
+            return false;
+
+        for (int i = 0; i < FootstepModel::N_FEATURES; ++i)
+            out[i] = static_cast<float>((*array)[i]);
+        return true;
+    }
+
+    bool readScaler(const juce::var& json, FeatureArray& means, FeatureArray& stds)
+    {
+        const juce::var& scaling = json["feature_scaling"];
+        if (scaling.isObject())
+            return readFeatureArray(scaling["means"], means) && readFeatureArray(scaling["stds"], stds);
+
+        return readFeatureArray(json["scaler_means"], means) && readFeatureArray(json["scaler_stds"], stds);
+    }
+
+    float readFloat(const juce::var& value, float fallback)
+    {
+        return value.isVoid() ? fallback : static_cast<float>(value);
+    }
+
+    // Top-N tier: one stump per top_features entry with that entry's own
+    // threshold (a feature can appear several times). Direction and probability
+    // come from the decision rule with the same feature and threshold; entries
+    // without one are left out rather than guessed.
+    std::shared_ptr<RuleFootstepModel> makeTopFeatureModel(const juce::var& topFeatures,
+                                                           const std::vector<RuleFootstepModel::Rule>& rules,
+                                                           const FeatureArray& means, const FeatureArray& stds)
+    {
+        auto* indexArray = topFeatures["indices"].getArray();
+        auto* thresholdArray = topFeatures["thresholds"].getArray();
+        auto* weightArray = topFeatures["weights"].getArray();
+        if (indexArray == nullptr || thresholdArray == nullptr || weightArray == nullptr
+            || indexArray->size() != thresholdArray->size() || indexArray->size() != weightArray->size())
+            return nullptr;
+
+        auto model = std::make_shared<RuleFootstepModel>(FootstepModel::Tier::TopFeatures);
+        model->setScaler(means, stds);
+
+        for (int i = 0; i < indexArray->size(); ++i) {
+            RuleFootstepModel::Rule rule;
+            rule.feature = static_cast<int>((*indexArray)[i]);
+            rule.threshold = static_cast<float>((*thresholdArray)[i]);
+            rule.weight = static_cast<float>((*weightArray)[i]);
+
+            auto match = std::find_if(rules.begin(), rules.end(), [&rule](const RuleFootstepModel::Rule& existing) {
+                return existing.feature == rule.feature && existing.threshold == rule.threshold;
+            });
+            if (match == rules.end())
+                continue;
+
+            rule.greaterThan = match->greaterThan;
+            rule.probability = match->probability;
+            model->addRule(rule);
+        }
+
+        return model->getNumRules() > 0 ? model : nullptr;
+    }
+}
+
+ModelRegistry::ModelRegistry()
+{
+}
+
+ModelRegistry::~ModelRegistry()
+{
+}
+
+int ModelRegistry::loadDirectory(const juce::File& directory)
+{
+    if (!directory.isDirectory())
+        return 0;
+
+    int added = 0;
+    juce::StringArray loadedFiles;
+
+    // A converted binary model takes the place of the JSON export it was made from
+    auto loadPreferringBinary = [&](const juce::File& jsonFile) {
+        juce::File binaryFile = jsonFile.withFileExtension(binaryModelExtension);
+        juce::File file = binaryFile.existsAsFile() ? binaryFile : jsonFile;
+        if (file.existsAsFile()) {
+            added += loadFile(file);
+            loadedFiles.add(jsonFile.getFileNameWithoutExtension());
+        }
+    };
+
+    for (auto* fileName : knownModelFiles)
+        loadPreferringBinary(directory.getChildFile(fileName));
+
+    // Any other exports in the directory, in a stable order
+    auto others = directory.findChildFiles(juce::File::findFiles, false, juce::String("*.json;*") + binaryModelExtension);
+    others.sort();
+    for (const auto& file : others)
+        if (!loadedFiles.contains(file.getFileNameWithoutExtension()))
+            loadPreferringBinary(file.withFileExtension(".json"));
+
+    return added;
+}
+
+int ModelRegistry::loadFile(const juce::File& file)
+{
+    if (!file.existsAsFile())
+        return 0;
+
+    if (file.hasFileExtension(binaryModelExtension))
+        return loadBinaryForest(file);
+
+    return loadFromJSON(file.getFileNameWithoutExtension(), file.loadFileAsString());
+}
+
+int ModelRegistry::loadFromMemory(const juce::String& fileName, const void* data, size_t size)
+{
+    juce::String source = juce::File::createFileWithoutCheckingPath(fileName).getFileNameWithoutExtension();
+
+    if (fileName.endsWithIgnoreCase(binaryModelExtension)) {
+        if (size < sizeof(RandomForestModel::BinaryHeader))
+            return 0;
+
+        RandomForestModel::BinaryHeader header;
+        std::memcpy(&header, data, sizeof(header));
+
+        return addSharedModels(getBinaryModelKey(source, header), [&](ModelRegistry& loader)
+        {
+            auto forest = std::make_shared<RandomForestModel>();
+            if (!forest->loadFromBinaryData(data, size))
+                return 0;
+
+            loader.addModel(source, forest);
+            return 1;
+        });
+    }
+
+    return loadFromJSON(source, juce::String::fromUTF8(static_cast<const char*>(data), static_cast<int>(size)));
+}
+
+juce::String ModelRegistry::getBinaryModelKey(const juce::String& source, const RandomForestModel::BinaryHeader& header)
+{
+    return source + ":fsm:" + juce::String::toHexString(static_cast<int>(header.payloadChecksum))
+         + ":" + juce::String(header.fileBytes);
+}
+
+int ModelRegistry::loadFromJSON(const juce::String& source, const juce::String& jsonText)
+{
+    juce::String key = source + ":json:" + juce::String::toHexString(static_cast<juce::int64>(jsonText.hashCode64()));
+    return addSharedModels(key, [&](ModelRegistry& loader) { return loader.parseJSON(source, jsonText); });
+}
+
+int ModelRegistry::addSharedModels(const juce::String& key, const std::function<int(ModelRegistry&)>& loadModels)
+{
+    // Quantized and float forests of the same file are different model objects
+    auto shared = SharedObjectCache<SharedModels>::getInstance().getOrCreate(quantizedForests ? key + ":int16" : key, [&]
+    {
+        ModelRegistry loader;
+        loader.quantizedForests = quantizedForests;
+        loadModels(loader);
+        return std::make_shared<SharedModels>(SharedModels { std::move(loader.entries) });
+    });
+
+    // Each entry shares ownership of the whole set, so the cache slot stays
+    // alive until no registry in the process uses any model from this file
+    for (const auto& entry : shared->entries)
+        entries.push_back({ entry.source, std::shared_ptr<const FootstepModel>(shared, entry.model.get()) });
+
+    return static_cast<int>(shared->entries.size());
+}
+
+int ModelRegistry::parseJSON(const juce::String& source, const juce::String& jsonText)
+{
+    juce::var json = juce::JSON::parse(jsonText);
+    if (!json.isObject()) {
+        std::cerr << "Model registry: " << source << " is not a JSON object" << std::endl;
+        return 0;
+    }
+
+    int added = 0;
+
+    if (json["trees"].isArray())
+        added = loadForest(source, jsonText);
+    else if (json["decision_rules"].isArray())
+        added = loadEnhancedRules(source, json);
+    else if (json["decision_rules"].isObject())
+        added = loadProfessionalRules(source, json);
+    else if (json["decision_rules_simplified"].isArray())
+        added = loadProductionRules(source, json);
+    else if (json["key_features"].isArray())
+        added = loadSimpleRules(source, json);
+
+    if (added == 0)
+        std::cout << "Model registry: no loadable model in " << source << std::endl;
+
+    return added;
+}
+
+std::vector<std::shared_ptr<const FootstepModel>> ModelRegistry::merge(ModelRegistry& other)
+{
+    std::vector<std::shared_ptr<const FootstepModel>> replaced;
+
+    juce::StringArray incomingSources;
+    for (const auto& entry : other.entries)
+        incomingSources.addIfNotAlreadyThere(entry.source);
+
+    for (auto it = entries.begin(); it != entries.end();) {
+        if (incomingSources.contains(it->source)) {
+            replaced.push_back(std::move(it->model));
+            it = entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    for (auto& entry : other.entries)
+        entries.push_back(std::move(entry));
+    other.entries.clear();
+
+    return replaced;
+}
+
+void ModelRegistry::addModel(const juce::String& source, std::shared_ptr<FootstepModel> model)
+{
+    if (auto* forest = dynamic_cast<RandomForestModel*>(model.get()))
+        forest->setQuantizedMode(quantizedForests);
+
+    model->setName(source + " [" + FootstepModel::getTierName(model->getTier()) + "]");
+    entries.push_back({ source, std::move(model) });
+}
+
+int ModelRegistry::loadForest(const juce::String& source, const juce::String& jsonText)
+{
+    auto forest = std::make_shared<RandomForestModel>();
+    if (!forest->loadFromJSON(jsonText))
+        return 0;
+
+    addModel(source, forest);
+    return 1;
+}
+
+int ModelRegistry::loadBinaryForest(const juce::File& file)
+{
+    // The header checksum identifies the content without mapping the file
+    RandomForestModel::BinaryHeader header{};
+    juce::FileInputStream input(file);
+    if (!input.openedOk() || input.read(&header, sizeof(header)) != static_cast<int>(sizeof(header)))
+        return 0;
+
+    juce::String source = file.getFileNameWithoutExtension();
+
+    return addSharedModels(getBinaryModelKey(source, header), [&](ModelRegistry& loader)
+    {
+        auto forest = std::make_shared<RandomForestModel>();
+        if (!forest->loadFromBinaryFile(file))
+            return 0;
+
+        loader.addModel(source, forest);
+        return 1;
+    });
+}
+
+int ModelRegistry::loadEnhancedRules(const juce::String& source, const juce::var& json)
+{
+    FeatureArray means, stds;
+    if (!readScaler(json, means, stds))
+        return 0;
+
+    auto rules = std::make_shared<RuleFootstepModel>(FootstepModel::Tier::SimplifiedRules);
+    rules->setScaler(means, stds);
+    rules->setDecisionThreshold(readFloat(json["thresholds"]["balanced"], 0.5f));
+
+    std::vector<RuleFootstepModel::Rule> parsedRules;
+    for (const auto& entry : *json["decision_rules"].getArray()) {
+        RuleFootstepModel::Rule rule;
+        rule.feature = static_cast<int>(entry["feature_idx"]);
+        rule.threshold = readFloat(entry["threshold"], 0.0f);
+        rule.weight = readFloat(entry["weight"], 1.0f);
+        rule.greaterThan = static_cast<bool>(entry["is_greater_than"]);
+        rule.probability = readFloat(entry["footstep_probability"], 1.0f);
+        rules->addRule(rule);
+        parsedRules.push_back(rule);
+    }
+
+    int added = 0;
+    if (rules->getNumRules() > 0) {
+        addModel(source, rules);
+        added++;
+    }
+
+    if (auto topModel = makeTopFeatureModel(json["top_features"], parsedRules, means, stds)) {
+        topModel->setDecisionThreshold(rules->getDecisionThreshold());
+        addModel(source, topModel);
+        added++;
+    }
+
+    return added;
+}
+
+int ModelRegistry::loadProfessionalRules(const juce::String& source, const juce::var& json)
+{
+    FeatureArray means, stds;
+    if (!readScaler(json, means, stds))
+        return 0;
+
+    float threshold = readFloat(json["model_info"]["optimal_threshold"], 0.5f);
+
+    auto rules = std::make_shared<RuleFootstepModel>(FootstepModel::Tier::SimplifiedRules);
+    rules->setScaler(means, stds);
+    rules->setDecisionThreshold(threshold);
+
+    if (auto* simplified = json["decision_rules"]["simplified_rules"].getArray()) {
+        for (const auto& entry : *simplified) {
+            RuleFootstepModel::Rule rule;
+            rule.feature = static_cast<int>(entry["feature_idx"]);
+            rule.threshold = readFloat(entry["threshold"], 0.0f);
+            rule.weight = readFloat(entry["importance"], 1.0f);
+            rule.greaterThan = entry["rule_type"].toString() != "less_than";
+            rules->addRule(rule);
+        }
+    }
+
+    // feature_importance only ranks features, it has no split thresholds for
+    // a Top-15 tier: that tier comes from the enhanced export
+    if (rules->getNumRules() == 0)
+        return 0;
+
+    addModel(source, rules);
+    return 1;
+}
+
+int ModelRegistry::loadProductionRules(const juce::String& source, const juce::var& json)
+{
+    FeatureArray means, stds;
+    if (!readScaler(json, means, stds))
+        return 0;
+
+    float threshold = readFloat(json["deployment_config"]["recommended_threshold"],
+                                readFloat(json["model_info"]["optimal_threshold"], 0.5f));
+
+    auto rules = std::make_shared<RuleFootstepModel>(FootstepModel::Tier::SimplifiedRules);
+    rules->setScaler(means, stds);
+    rules->setDecisionThreshold(threshold);
+
+    // The rules carry no direction: they are the top three greater_than rules
+    // of the professional export with retuned thresholds, so greaterThan holds.
+    // As there, feature_importance has no thresholds for a Top-15 tier.
+    for (const auto& entry : *json["decision_rules_simplified"].getArray()) {
+        RuleFootstepModel::Rule rule;
+        rule.feature = static_cast<int>(entry["feature_idx"]);
+        rule.threshold = readFloat(entry["threshold"], 0.0f);
+        rule.weight = readFloat(entry["importance"], 1.0f);
+        rule.greaterThan = true;
+        rules->addRule(rule);
+    }
+
+    if (rules->getNumRules() == 0)
+        return 0;
+
+    addModel(source, rules);
+    return 1;
+}
+
+int ModelRegistry::loadSimpleRules(const juce::String& source, const juce::var& json)
+{
+    FeatureArray means, stds;
+    if (!readScaler(json, means, stds))
+        return 0;
+
+    auto* features = json["key_features"].getArray();
+    auto* thresholds = json["key_thresholds"].getArray();
+    if (thresholds == nullptr || thresholds->size() != features->size())
+        return 0;
+
+    auto rules = std::make_shared<RuleFootstepModel>(FootstepModel::Tier::SimplifiedRules);
+    rules->setScaler(means, stds);
+    rules->setDecisionThreshold(readFloat(json["classification_threshold"], 0.5f));
+
+    for (int i = 0; i < features->size(); ++i) {
+        RuleFootstepModel::Rule rule;
+        rule.feature = static_cast<int>((*features)[i]);
+        rule.threshold = static_cast<float>((*thresholds)[i]);
+        rules->addRule(rule);
+    }
+
+    if (rules->getNumRules() == 0)
+        return 0;
+
+    addModel(source, rules);
+    return 1;
+}
+
+std::shared_ptr<const FootstepModel> ModelRegistry::getModel(FootstepModel::Tier tier) const
+{
+    if (auto preferred = getModel(preferredSource, tier))
+        return preferred;
+
+    for (const auto& entry : entries)
+        if (entry.model->getTier() == tier)
+            return entry.model;
+
+    return nullptr;
+}
+
+std::shared_ptr<const FootstepModel> ModelRegistry::getModel(const juce::String& source, FootstepModel::Tier tier) const
+{
+    for (const auto& entry : entries)
+        if (entry.source == source && entry.model->getTier() == tier)
+            return entry.model;
+
+    return nullptr;
+}
+
+void ModelRegistry::printModelTable() const
+{
+    std::cout << "MODEL REGISTRY: " << entries.size() << " models" << std::endl;
+    for (const auto& entry : entries) {
+        std::cout << "   " << std::left << std::setw(52) << entry.model->getName().toStdString() << std::right
+                  << " ops: " << std::setw(5) << entry.model->getOperationsPerInference()
+                  << " | bytes: " << std::setw(7) << entry.model->getModelBytes()
+                  << " | threshold: " << entry.model->getDecisionThreshold() << std::endl;
+    }
+}
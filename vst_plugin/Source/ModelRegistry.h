@@ -0,0 +1,92 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include "FootstepModel.h"
+#include "RandomForestModel.h"
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Loads every shipped model export through the FootstepModel interface and
+// resolves an operator-selected CPU tier to a concrete model.
+//
+// Supported exports:
+//  - footstep_model_cpp.json            full forest
+//  - enhanced_footstep_model.json       decision_rules + top_features
+//  - professional_footstep_model.json   simplified_rules
+//  - production_footstep_model.json     decision_rules_simplified
+//  - footstep_model_simple.json         key_features / key_thresholds
+//
+// A forest converted to the binary format (<name>.fsm next to <name>.json)
+// is memory-mapped instead of parsing the JSON.
+//
+// Loaded models are immutable and shared process-wide: registries loading the
+// same file content (same source name and hash) get the same model objects.
+class ModelRegistry
+{
+public:
+    static constexpr const char* binaryModelExtension = ".fsm";
+
+    struct Entry
+    {
+        juce::String source;    // file name without extension
+        std::shared_ptr<const FootstepModel> model;
+    };
+
+    ModelRegistry();
+    ~ModelRegistry();
+
+    // Returns the number of models added
+    int loadDirectory(const juce::File& directory);
+    int loadFile(const juce::File& file);
+    int loadFromJSON(const juce::String& source, const juce::String& jsonText);
+
+    // A JSON export or .fsm image held in memory that outlives the models
+    // (compiled-in BinaryData); the format is chosen from the file name
+    int loadFromMemory(const juce::String& fileName, const void* data, size_t size);
+
+    // Best model for a tier: the preferred source if it provides one,
+    // otherwise the first loaded source that does
+    std::shared_ptr<const FootstepModel> getModel(FootstepModel::Tier tier) const;
+    std::shared_ptr<const FootstepModel> getModel(const juce::String& source, FootstepModel::Tier tier) const;
+
+    // Moves the entries of another registry into this one. Sources that are
+    // reloaded replace their old entries, which are returned for retirement.
+    std::vector<std::shared_ptr<const FootstepModel>> merge(ModelRegistry& other);
+
+    void setPreferredSource(const juce::String& source) { preferredSource = source; }
+
+    // Forests loaded from now on infer on int16 features and thresholds (see
+    // RandomForestModel::setQuantizedMode); forests too large for it stay float
+    void setQuantizedForests(bool shouldQuantize) { quantizedForests = shouldQuantize; }
+    bool hasQuantizedForests() const { return quantizedForests; }
+    const std::vector<Entry>& getEntries() const { return entries; }
+    bool isEmpty() const { return entries.empty(); }
+
+    void printModelTable() const;
+
+private:
+    // One loaded file, as held by the process-wide cache
+    struct SharedModels
+    {
+        std::vector<Entry> entries;
+    };
+
+    std::vector<Entry> entries;
+    juce::String preferredSource = "footstep_model_cpp";
+    bool quantizedForests = false;
+
+    void addModel(const juce::String& source, std::shared_ptr<FootstepModel> model);
+    int addSharedModels(const juce::String& key, const std::function<int(ModelRegistry&)>& loadModels);
+    int parseJSON(const juce::String& source, const juce::String& jsonText);
+
+    int loadForest(const juce::String& source, const juce::String& jsonText);
+    int loadBinaryForest(const juce::File& file);
+    static juce::String getBinaryModelKey(const juce::String& source, const RandomForestModel::BinaryHeader& header);
+    int loadEnhancedRules(const juce::String& source, const juce::var& json);
+    int loadProfessionalRules(const juce::String& source, const juce::var& json);
+    int loadProductionRules(const juce::String& source, const juce::var& json);
+    int loadSimpleRules(const juce::String& source, const juce::var& json);
+
+    JUCE_DECLARE_NON_COPYABLE(ModelRegistry)
+};
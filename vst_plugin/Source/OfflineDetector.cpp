@@ -0,0 +1,112 @@
+#include "OfflineDetector.h"
+#include <algorithm>
+#include <cstring>
+
+OfflineDetector::OfflineDetector() = default;
+
+OfflineDetector::~OfflineDetector() = default;
+
+void OfflineDetector::prepare(double sampleRate, int maximumBlockSize, juce::ThreadPool* pool, int numThreads)
+{
+    threadPool = pool;
+    cooldownSamples = getCooldownSamples(sampleRate);
+
+    const int blockSize = juce::jmax(1, maximumBlockSize);
+    history.assign(static_cast<size_t>(window - 1 + blockSize), 0.0f);
+    decisions.resize(static_cast<size_t>(blockSize / hop + 1));
+    events.reserve(decisions.size());
+    candidates.reserve(decisions.size());
+
+    // The calling thread takes one job itself
+    const int numJobs = pool != nullptr ? juce::jmax(1, numThreads) + 1 : 1;
+    scratch.resize(static_cast<size_t>(numJobs));
+    for (auto& jobScratch : scratch) {
+        if (jobScratch == nullptr)
+            jobScratch = std::make_unique<MLFootstepClassifier::Scratch>();
+        jobScratch->mfcc.prepare(sampleRate);
+    }
+
+    reset();
+}
+
+void OfflineDetector::reset()
+{
+    std::fill(history.begin(), history.end(), 0.0f);
+    events.clear();
+    candidates.clear();
+    processedSamples = 0;
+    nextDecision = 0;
+}
+
+const std::vector<OfflineDetector::Event>& OfflineDetector::process(const MLFootstepClassifier& classifier, const float* analysis, int numSamples, float sensitivity)
+{
+    events.clear();
+    candidates.clear();
+    numSamples = juce::jmin(numSamples, static_cast<int>(history.size()) - (window - 1));
+    if (numSamples <= 0)
+        return events;
+
+    std::memcpy(history.data() + window - 1, analysis, sizeof(float) * static_cast<size_t>(numSamples));
+
+    // Decisions on the hop grid: after every hop-th sample since the reset
+    int numDecisions = 0;
+    for (int offset = static_cast<int>(hop - 1 - processedSamples % hop); offset < numSamples; offset += hop)
+        decisions[static_cast<size_t>(numDecisions++)].offset = offset;
+
+    // Runs of at least minHopsPerJob decisions go to the pool, the first stays here
+    const int numJobs = juce::jlimit(1, static_cast<int>(scratch.size()), numDecisions / minHopsPerJob);
+    const int perJob = (numDecisions + numJobs - 1) / numJobs;
+
+    if (numJobs > 1) {
+        jobsRunning.store(numJobs - 1);
+
+        for (int job = 1; job < numJobs; ++job) {
+            const int first = job * perJob;
+            const int end = juce::jmin(numDecisions, first + perJob);
+            auto* jobScratch = scratch[static_cast<size_t>(job)].get();
+
+            threadPool->addJob([this, &classifier, first, end, sensitivity, jobScratch]
+            {
+                score(classifier, first, end, sensitivity, *jobScratch);
+                if (jobsRunning.fetch_sub(1) == 1)
+                    jobsFinished.signal();
+            });
+        }
+    }
+
+    score(classifier, 0, juce::jmin(numDecisions, perJob), sensitivity, *scratch.front());
+
+    if (numJobs > 1)
+        jobsFinished.wait(-1);
+
+    // Cooldown in time order, as the streaming classifier applies it
+    for (int index = 0; index < numDecisions; ++index) {
+        const auto& decision = decisions[static_cast<size_t>(index)];
+        const juce::int64 position = processedSamples + decision.offset;
+
+        if (!decision.result.footstep)
+            continue;
+
+        candidates.push_back({ decision.offset, decision.result.onsetAge, decision.result.confidence });
+
+        if (position >= nextDecision) {
+            events.push_back({ decision.offset, decision.result.onsetAge, decision.result.confidence });
+            nextDecision = position + cooldownSamples + 1;
+        }
+    }
+
+    // Keep the last window - 1 samples for the next block
+    std::memmove(history.data(), history.data() + numSamples, sizeof(float) * static_cast<size_t>(window - 1));
+    processedSamples += numSamples;
+
+    return events;
+}
+
+void OfflineDetector::score(const MLFootstepClassifier& classifier, int firstDecision, int endDecision, float sensitivity, MLFootstepClassifier::Scratch& jobScratch)
+{
+    // Block sample n sits at window - 1 + n in the history, so its window starts at n
+    for (int index = firstDecision; index < endDecision; ++index) {
+        auto& decision = decisions[static_cast<size_t>(index)];
+        decision.result = classifier.decide(history.data() + decision.offset, sensitivity, jobScratch);
+    }
+}
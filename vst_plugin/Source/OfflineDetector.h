@@ -0,0 +1,80 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include "MLFootstepClassifier.h"
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// OFFLINE RENDER: high-accuracy detection for non-realtime bounces. The streaming
+// classifier skips decisions to stay cheap (adaptive hop, hold-off after each
+// step); here every hop is scored, on a fixed grid counted from the last reset,
+// with MLFootstepClassifier::decide on the whole window ending there.
+//
+// Scores depend only on their window, so a large block is split into runs of
+// hops that a juce::ThreadPool scores in parallel, each job with its own
+// scratch. The cooldown is applied afterwards in time order, which makes the
+// detections independent of block sizes and of the number of threads.
+class OfflineDetector
+{
+public:
+    struct Event
+    {
+        int offset;             // sample in the block that triggered the detection
+        int onsetAge;           // see MLFootstepClassifier::getLastOnsetAge
+        float confidence;
+    };
+
+    OfflineDetector();
+    ~OfflineDetector();
+
+    // Sizes the history and scratch. The pool may be shared between detectors
+    // that are not processed at the same time; nullptr scores on the caller only.
+    void prepare(double sampleRate, int maximumBlockSize, juce::ThreadPool* pool, int numThreads);
+    void reset();
+    bool isPrepared() const { return !history.empty(); }
+
+    // Scores the block with the classifier's current model. Blocks up to the
+    // prepared size; the returned events stay valid until the next call.
+    const std::vector<Event>& process(const MLFootstepClassifier& classifier, const float* analysis, int numSamples, float sensitivity);
+
+    // Every footstep decision of the last block, before the cooldown
+    const std::vector<Event>& getCandidates() const { return candidates; }
+
+    // First sample, counted from the reset, that may trigger a detection again
+    juce::int64 getCooldownEnd() const { return nextDecision; }
+
+    static constexpr int hop = 64;
+    static constexpr double cooldownSeconds = 0.1;   // as the streaming classifier's
+
+    // A detection at sample n blocks detections up to n + getCooldownSamples()
+    static int getCooldownSamples(double sampleRate) { return static_cast<int>(sampleRate * cooldownSeconds); }
+
+private:
+    static constexpr int window = MLFootstepClassifier::WINDOW_SIZE;
+    static constexpr int minHopsPerJob = 16;         // below this a job costs more than it saves
+
+    struct Decision
+    {
+        int offset;
+        MLFootstepClassifier::Decision result;
+    };
+
+    juce::ThreadPool* threadPool = nullptr;
+    std::vector<std::unique_ptr<MLFootstepClassifier::Scratch>> scratch;   // one per job
+
+    std::vector<float> history;         // window - 1 samples of the past, then the block
+    std::vector<Decision> decisions;
+    std::vector<Event> events;
+    std::vector<Event> candidates;
+    int cooldownSamples = 0;
+    juce::int64 processedSamples = 0;   // since reset
+    juce::int64 nextDecision = 0;       // first sample out of the cooldown
+
+    std::atomic<int> jobsRunning { 0 };
+    juce::WaitableEvent jobsFinished;
+
+    void score(const MLFootstepClassifier& classifier, int firstDecision, int endDecision, float sensitivity, MLFootstepClassifier::Scratch& jobScratch);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OfflineDetector)
+};
@@ -6,8 +6,17 @@
 #include <juce_audio_basics/juce_audio_basics.h>
 #include <juce_dsp/juce_dsp.h>
 #include "MLFootstepClassifier.h"  // ONLY ML classifier
+#include "ModelRegistry.h"
+#include "FootstepEQ.h"
+#include "AnalysisWorker.h"
+#include "EnergyGate.h"
+#include "DegradeLadder.h"
+#include "SampleSanitizer.h"
+#include "SpeakerGroups.h"
+#include "OfflineDetector.h"
 
-class FootstepDetectorAudioProcessor : public juce::AudioProcessor
+class FootstepDetectorAudioProcessor : public juce::AudioProcessor,
+                                       private juce::Timer
 {
 public:
     FootstepDetectorAudioProcessor();
@@ -42,24 +51,107 @@ public:
     void setParameter(int index, float value) override;
     const juce::String getParameterName(int index) override;
     const juce::String getParameterText(int index) override;
-    int getNumParameters() override { return 3; }
+    int getNumParameters() override { return 11; }
 
     juce::AudioProcessorValueTreeState parameters;
     
     std::atomic<float>* sensitivityParam = nullptr;
     std::atomic<float>* enhancementParam = nullptr;
     std::atomic<float>* bypassParam = nullptr;
+    std::atomic<float>* modelTierParam = nullptr;
+    std::atomic<float>* lookaheadParam = nullptr;
+    std::atomic<float>* backgroundAnalysisParam = nullptr;
+    std::atomic<float>* latencyBudgetParam = nullptr;
+    std::atomic<float>* cpuGuardParam = nullptr;
+    std::atomic<float>* analysisMixParam = nullptr;
+    std::atomic<float>* sidechainParam = nullptr;
+    std::atomic<float>* offlineAccuracyParam = nullptr;
 
     // SIMPLIFIED: Only ML classifier
     MLFootstepClassifier* getFootstepClassifier() const { return mlFootstepClassifier.get(); }
+    const ModelRegistry& getModelRegistry() const { return modelRegistry; }
+    
+    // MODEL HOT-SWAP: parsing runs on a background thread, the result is picked
+    // up by the audio thread at the next block boundary. Files may be single
+    // JSON exports or model directories; a non-empty preferredSource makes that
+    // export the one the tier parameter resolves to (for live A/B).
+    void loadModelsAsync(const juce::Array<juce::File>& files, const juce::String& preferredSource = {});
+    void loadModelAsync(const juce::File& file) { loadModelsAsync({ file }, file.getFileNameWithoutExtension()); }
+    
+    // For hosts without a running message loop (offline tools)
+    void waitForModelLoads(int timeoutMs);
+    
+    // Analysis signals the current layout and "analysisMix" setting give (message thread)
+    int getNumAnalysisSignals() const;
+    bool isAnalysingSidechain() const;
+    juce::String getAnalysisSignalName(int signal) const;
+    
+    // Background analysis: chunks whose deadline passed before the worker got to them
+    juce::int64 getAnalysisFallbackCount() const { return analysisFallbacks.load(std::memory_order_relaxed); }
+    
+    // CPU guard telemetry. Detection levels: 0 = energy gate, 1 = simplified rules
+    // (or the built-in weights when selected), 2 = top-15 features, 3 = full forest.
+    int getDetectionLevel() const { return detectionLevel.load(std::memory_order_relaxed); }
+    const DegradeLadder& getDegradeLadder() const { return degradeLadder; }
+    static juce::String getDetectionLevelName(int level);
 
 private:
     // CLEAN: Only ML classifier, no fallback complexity
     std::unique_ptr<MLFootstepClassifier> mlFootstepClassifier;
     
-    std::vector<juce::dsp::IIR::Filter<float>> lowShelfFilter;
-    std::vector<juce::dsp::IIR::Filter<float>> midShelfFilter;
-    std::vector<juce::dsp::IIR::Filter<float>> highShelfFilter;
+    // JSON model exports selectable through the "modelTier" parameter (message thread only)
+    ModelRegistry modelRegistry;
+    
+    // Background loading: parsed registries wait here until the message thread merges them
+    std::unique_ptr<juce::ThreadPool> modelLoader;    // created on first use
+    juce::CriticalSection loadedModelsLock;
+    std::vector<std::unique_ptr<ModelRegistry>> loadedRegistries;
+    juce::String loadedPreferredSource;
+    bool overrideModelsRequested = false;
+    
+    // Publication: the message thread stores a pointer, the audio thread takes it at block start
+    const FootstepModel* publishedModel = nullptr;
+    std::atomic<const FootstepModel*> pendingModel { nullptr };
+    std::array<const FootstepModel*, FootstepModel::NUM_TIERS> publishedLadder {};    // one model per tier
+    std::array<std::atomic<const FootstepModel*>, FootstepModel::NUM_TIERS> pendingLadder {};
+    std::atomic<bool> modelPending { false };
+    std::atomic<uint64_t> blockEpoch { 0 };
+    
+    // Replaced models are freed on the message thread once two blocks have started since
+    struct RetiredModel
+    {
+        std::shared_ptr<const FootstepModel> model;
+        uint64_t epoch;
+    };
+    std::vector<RetiredModel> retiredModels;
+    
+    // Held by prepare and release, tried by the timer: they all touch detectionGroups
+    // and the models, and hosts may call prepareToPlay off the message thread
+    juce::CriticalSection preparationLock;
+    
+    void timerCallback() override;
+    void applyLoadedModels();
+    void publishSelectedModel();
+    void releaseRetiredModels();
+    void updateLookahead();
+    void updateAnalysisWorker();
+    void reportTierChanges();
+    
+    // Configuration the detector was last built for (see prepareDetector)
+    double preparedSampleRate = 0.0;
+    int preparedBlockSize = 0;
+    juce::AudioChannelSet preparedLayout;
+    juce::AudioChannelSet preparedSidechainLayout;
+    bool preparedNonRealtime = false;
+    
+    void prepareDetector(double sampleRate, int samplesPerBlock);
+    void initialiseDetector();
+    void resetEQFilters();
+    void resetEnvelope();
+    void resetLookahead();
+    
+    // Footstep band EQ, all channels in SIMD lanes, run on every block
+    FootstepEQ footstepEQ;
     
     mutable juce::CriticalSection processingLock;
     bool isProcessing = false;
@@ -73,8 +165,112 @@ private:
     int footstepHoldDuration = 0;
     bool inHoldPhase = false;
     
-    float applyFootstepEQ(float sample, int channel);
-    float applyMultiBandEQ(float sample, int channel);
+    // Debug output counters, per instance: hosts run instances on separate threads
+    int debugCounter = 0;
+    int detectionCount = 0;
+    int ampDebugCounter = 0;
+    
+    // Enhancement stage, per block: analysis downmix -> detection offsets -> gain curve
+    // -> EQ of all channels -> gain, limiting and crossfade with vector ops
+    static constexpr float enhancementThreshold = 1.02f;  // envelope level where the enhanced path fades in
+    static constexpr double crossfadeSeconds = 0.005;
+    std::vector<float> gainCurve;
+    juce::AudioBuffer<float> enhancedBuffer;
+    std::vector<float> limiterScratch;
+    std::vector<float> crossfadeCurve;
+    float enhancementMix = 0.0f;           // crossfade position, 0 = dry
+    float crossfadeStep = 1.0f;
+    std::vector<int> detectionOffsets;
+    
+    // LOOKAHEAD (optional): the output is delayed and reported as latency, so the gain
+    // can start on the estimated onset instead of at the later detection
+    static constexpr float maxLookaheadMs = 50.0f;
+    static constexpr size_t maxPendingOnsets = 16;
+    juce::AudioBuffer<float> lookaheadRing;               // sized for maxLookaheadMs
+    int lookaheadPosition = 0;
+    int activeLookahead = 0;                              // audio thread
+    std::atomic<int> lookaheadSamples { 0 };              // set by the message thread
+    juce::int64 samplePosition = 0;                       // input samples, never reset
+    std::vector<juce::int64> pendingOnsets;               // gain starts, output time
+    
+    // BACKGROUND ANALYSIS (optional): the detector runs on AnalysisWorker. Each decision
+    // waits at most the latency budget (after the block that delivered the audio) for the
+    // worker; input it has not analysed by then is decided by the energy gate instead.
+    static constexpr float maxLatencyBudgetMs = 50.0f;
+    
+    struct GateOnset
+    {
+        juce::int64 position;
+        int onsetAge;
+    };
+    
+    // SURROUND: one detection group per analysis signal (see SpeakerGroups). Group 0 runs
+    // on mlFootstepClassifier; the others own a classifier, and in the background each
+    // group has its own worker thread, so speaker groups spread across cores. Every
+    // group's detections drive the one gain envelope that all channels share.
+    struct DetectionGroup
+    {
+        std::vector<float> signal;
+        std::unique_ptr<MLFootstepClassifier> classifier;     // groups after the first
+        std::unique_ptr<AnalysisWorker> worker;               // started on demand
+        std::unique_ptr<OfflineDetector> offline;             // prepared for non-realtime only
+        EnergyGate gate;                                      // CPU guard level 0, background fallback
+        std::vector<GateOnset> gateOnsets;                    // provisional, until their deadline
+        juce::int64 gateDecidedFrom = 0;                      // input stretch decided by the gate:
+        juce::int64 gateDecidedUntil = 0;                     // worker results inside it are dropped
+    };
+    
+    static constexpr int maxChannels = 16;                // up to 9.1.6
+    SpeakerGroups speakerGroups;
+    std::vector<DetectionGroup> detectionGroups;          // one per speaker group of the larger layout
+    int activeAnalysisMix = -1;                           // audio thread, -1 = restart detection
+    
+    // SIDECHAIN (optional): with "sidechain" on and the bus connected, the detectors run on
+    // the sidechain input (e.g. the game stem alone) and the gain goes to the main bus
+    SpeakerGroups sidechainGroups;
+    int sidechainChannel = 0;                             // first sidechain channel in processBlock's buffer
+    int numSidechainChannels = 0;                         // 0 = bus disabled
+    bool analysingSidechain = false;                      // audio thread
+    int numAnalysisSignals = 1;
+    static constexpr double groupMergeSeconds = 0.05;     // one step heard by several groups
+    int groupMergeSamples = 0;
+    juce::int64 lastScheduledOnset = 0;
+    bool analysingInBackground = false;                   // audio thread
+    std::atomic<juce::int64> analysisFallbacks { 0 };
+    
+    // OFFLINE RENDER: when the host bounces (isNonRealtime) with "offlineAccuracy" on, the
+    // selected tier scores every hop inline, large blocks split across the pool's threads
+    std::unique_ptr<juce::ThreadPool> offlinePool;        // created by the first non-realtime prepare
+    int numOfflineThreads = 0;
+    bool renderingOffline = false;                        // audio thread
+    
+    // CPU GUARD: inline detection steps down forest -> top-15 -> rules -> energy gate
+    // while processBlock is short of real-time headroom (off for offline rendering)
+    DegradeLadder degradeLadder;
+    const FootstepModel* selectedModel = nullptr;                     // audio thread copies of
+    std::array<const FootstepModel*, FootstepModel::NUM_TIERS> ladderModels {};   // the published models
+    int activeDetectionLevel = -1;                                    // -1 = apply at the next block
+    std::atomic<int> detectionLevel { 1 };
+    
+    int getSelectedDetectionLevel() const;
+    void applyDetectionLevel(int level);
+    
+    void applyLookaheadDelay(juce::AudioBuffer<float>& buffer, int start, int numSamples, int numChannels);
+    SpeakerGroups::Mode getAnalysisMix() const;
+    MLFootstepClassifier& getClassifier(size_t group);
+    void restartDetection();
+    bool backgroundWorkersRunning(int numSignals) const;
+    const SpeakerGroups& getAnalysisGroups(bool sidechain) const { return sidechain ? sidechainGroups : speakerGroups; }
+    void renderAnalysisSignals(juce::AudioBuffer<float>& buffer, int start, int numSamples, int numChannels);
+    void detectFootsteps(size_t group, int numSamples, float sensitivity, float enhancement);
+    void detectFootstepsInBackground(DetectionGroup& group, int numSamples, float sensitivity, int budgetSamples);
+    void detectFootstepsOffline(size_t group, int numSamples, float sensitivity);
+    void scheduleOnset(juce::int64 detectionPosition, int onsetAge);
+    void collectDueOnsets(int numSamples);
+    void renderGainCurve(int numSamples, float enhancement);
+    void renderCrossfade(int numSamples);
+    void applyEnhancement(float* channelData, float* enhanced, int numSamples);
+    
     void getEditorSize(int& width, int& height);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FootstepDetectorAudioProcessor)
@@ -0,0 +1,462 @@
+#include "RandomForestModel.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+// The binary format stores these structs verbatim
+static_assert(sizeof(RandomForestModel::Node) == 16, "Node layout is part of the binary model format");
+static_assert(sizeof(RandomForestModel::QuantizedNode) == 8, "QuantizedNode layout is part of the binary model format");
+static_assert(sizeof(RandomForestModel::BinaryHeader) == 64, "BinaryHeader layout is part of the binary model format");
+
+namespace
+{
+    uint32_t alignSection(size_t offset)
+    {
+        const size_t alignment = RandomForestModel::SECTION_ALIGNMENT;
+        return static_cast<uint32_t>((offset + alignment - 1) / alignment * alignment);
+    }
+}
+
+RandomForestModel::RandomForestModel()
+{
+    scalerStds.fill(1.0f);
+}
+
+RandomForestModel::~RandomForestModel()
+{
+}
+
+bool RandomForestModel::loadFromFile(const juce::File& jsonFile)
+{
+    if (!jsonFile.existsAsFile()) {
+        std::cerr << "Forest model not found: " << jsonFile.getFullPathName() << std::endl;
+        return false;
+    }
+
+    return loadFromJSON(jsonFile.loadFileAsString());
+}
+
+void RandomForestModel::clear()
+{
+    nodeStorage.clear();
+    quantizedNodeStorage.clear();
+    treeRootStorage.clear();
+    mappedFile.reset();
+    imageCopy.free();
+
+    nodes = nullptr;
+    quantizedNodes = nullptr;
+    treeRoots = nullptr;
+    quantizedAvailable = false;
+    numTrees = 0;
+    numNodes = 0;
+    totalPathLength = 0;
+}
+
+void RandomForestModel::setScaler(const float* means, const float* stds)
+{
+    for (int i = 0; i < N_FEATURES; ++i) {
+        scalerMeans[i] = means[i];
+        scalerStds[i] = std::max(stds[i], 1e-6f);
+        quantizationScales[i] = Q_ONE / scalerStds[i];
+    }
+}
+
+void RandomForestModel::useOwnedStorage()
+{
+    nodes = nodeStorage.data();
+    quantizedNodes = quantizedNodeStorage.data();
+    treeRoots = treeRootStorage.data();
+    numTrees = static_cast<int>(treeRootStorage.size());
+    numNodes = static_cast<int>(nodeStorage.size());
+}
+
+bool RandomForestModel::loadFromJSON(const juce::String& jsonText)
+{
+    clear();
+
+    juce::var json = juce::JSON::parse(jsonText);
+    auto* means = json["scaler_means"].getArray();
+    auto* stds = json["scaler_stds"].getArray();
+    auto* trees = json["trees"].getArray();
+
+    if (means == nullptr || stds == nullptr || trees == nullptr
+        || means->size() != N_FEATURES || stds->size() != N_FEATURES) {
+        std::cerr << "Forest model JSON is missing scaler or tree data" << std::endl;
+        return false;
+    }
+
+    FeatureVector meanValues, stdValues;
+    for (int i = 0; i < N_FEATURES; ++i) {
+        meanValues[i] = static_cast<float>((*means)[i]);
+        stdValues[i] = static_cast<float>((*stds)[i]);
+    }
+    setScaler(meanValues.data(), stdValues.data());
+
+    featureImportance.fill(0.0f);
+    if (auto* importance = json["feature_importance"].getArray())
+        for (int i = 0; i < std::min(N_FEATURES, importance->size()); ++i)
+            featureImportance[i] = static_cast<float>((*importance)[i]);
+
+    for (const auto& tree : *trees) {
+        if (!appendTree(tree)) {
+            std::cerr << "Forest model JSON has a malformed tree #" << treeRootStorage.size() << std::endl;
+            clear();
+            return false;
+        }
+    }
+
+    quantizedAvailable = buildQuantizedNodes();
+    useOwnedStorage();
+
+    std::cout << "Random forest loaded: " << numTrees << " trees, "
+              << numNodes << " nodes (" << getFloatModelBytes() << " bytes float, ";
+    if (quantizedAvailable)
+        std::cout << getQuantizedModelBytes() << " bytes int16)" << std::endl;
+    else
+        std::cout << "no int16 mode: a tree is too large for 16-bit child offsets)" << std::endl;
+    return numTrees > 0;
+}
+
+bool RandomForestModel::loadFromBinaryFile(const juce::File& binaryFile, bool verifyChecksum)
+{
+    clear();
+
+    auto mapped = std::make_unique<juce::MemoryMappedFile>(binaryFile, juce::MemoryMappedFile::readOnly);
+    const auto* data = static_cast<const char*>(mapped->getData());
+
+    if (data == nullptr) {
+        std::cerr << "Binary forest model could not be mapped: " << binaryFile.getFullPathName() << std::endl;
+        return false;
+    }
+
+    if (!useBinaryImage(data, mapped->getSize(), verifyChecksum, binaryFile.getFullPathName()))
+        return false;
+
+    mappedFile = std::move(mapped);
+
+    std::cout << "Random forest mapped: " << numTrees << " trees, " << numNodes << " nodes from "
+              << binaryFile.getFileName() << " (" << mappedFile->getSize() << " bytes)" << std::endl;
+    return true;
+}
+
+bool RandomForestModel::loadFromBinaryData(const void* data, size_t size, bool verifyChecksum)
+{
+    clear();
+
+    // Compiled-in resources are only byte aligned; copy once if the nodes would be misaligned
+    const auto* image = static_cast<const char*>(data);
+    if (reinterpret_cast<uintptr_t>(image) % alignof(Node) != 0) {
+        imageCopy.malloc(size);
+        std::memcpy(imageCopy.get(), data, size);
+        image = imageCopy.get();
+    }
+
+    if (!useBinaryImage(image, size, verifyChecksum, "binary data")) {
+        imageCopy.free();
+        return false;
+    }
+
+    return true;
+}
+
+bool RandomForestModel::useBinaryImage(const char* data, size_t size, bool verifyChecksum, const juce::String& description)
+{
+    if (size < sizeof(BinaryHeader)) {
+        std::cerr << "Binary forest model is too small: " << description << std::endl;
+        return false;
+    }
+
+    const auto& header = *reinterpret_cast<const BinaryHeader*>(data);
+
+    if (header.magic != BINARY_MAGIC || header.version != BINARY_VERSION) {
+        std::cerr << "Binary forest model has an unknown magic/version: " << description << std::endl;
+        return false;
+    }
+
+    auto sectionFits = [&](uint32_t offset, size_t bytes) {
+        return offset % SECTION_ALIGNMENT == 0 && offset >= header.headerBytes && offset + bytes <= header.fileBytes;
+    };
+
+    const size_t featureBytes = N_FEATURES * sizeof(float);
+    if (header.headerBytes < sizeof(BinaryHeader) || header.fileBytes != size
+        || header.numFeatures != static_cast<uint32_t>(N_FEATURES) || header.numTrees == 0
+        || !sectionFits(header.scalerMeansOffset, featureBytes)
+        || !sectionFits(header.scalerStdsOffset, featureBytes)
+        || !sectionFits(header.importanceOffset, featureBytes)
+        || !sectionFits(header.treeRootsOffset, header.numTrees * sizeof(int32_t))
+        || !sectionFits(header.nodesOffset, header.numNodes * sizeof(Node))
+        || !sectionFits(header.quantizedNodesOffset, header.numNodes * sizeof(QuantizedNode))) {
+        std::cerr << "Binary forest model is truncated or malformed: " << description << std::endl;
+        return false;
+    }
+
+    if (verifyChecksum
+        && calculateChecksum(data + header.headerBytes, header.fileBytes - header.headerBytes) != header.payloadChecksum) {
+        std::cerr << "Binary forest model checksum mismatch: " << description << std::endl;
+        return false;
+    }
+
+    const auto* imageNodes = reinterpret_cast<const Node*>(data + header.nodesOffset);
+    const auto* imageQuantizedNodes = reinterpret_cast<const QuantizedNode*>(data + header.quantizedNodesOffset);
+    const auto* imageTreeRoots = reinterpret_cast<const int32_t*>(data + header.treeRootsOffset);
+
+    // A consistent checksum says nothing about where the nodes point
+    if (!treesAreValid(imageNodes, imageQuantizedNodes, imageTreeRoots,
+                       static_cast<int>(header.numTrees), static_cast<int>(header.numNodes))) {
+        std::cerr << "Binary forest model has malformed trees: " << description << std::endl;
+        return false;
+    }
+
+    setScaler(reinterpret_cast<const float*>(data + header.scalerMeansOffset),
+              reinterpret_cast<const float*>(data + header.scalerStdsOffset));
+    std::copy_n(reinterpret_cast<const float*>(data + header.importanceOffset), N_FEATURES, featureImportance.begin());
+
+    nodes = imageNodes;
+    quantizedNodes = imageQuantizedNodes;
+    treeRoots = imageTreeRoots;
+    quantizedAvailable = true;
+    numTrees = static_cast<int>(header.numTrees);
+    numNodes = static_cast<int>(header.numNodes);
+    totalPathLength = static_cast<int>(header.totalPathLength);
+    decisionThreshold = header.decisionThreshold;
+
+    return true;
+}
+
+bool RandomForestModel::treesAreValid(const Node* treeNodes, const QuantizedNode* treeQuantizedNodes,
+                                      const int32_t* roots, int numTreesToCheck, int numNodesToCheck)
+{
+    // The layout appendTree builds: trees stored back to back in pre-order, each
+    // split's children inside its own tree, features within the vector, and the
+    // int16 nodes the same tree as the float ones
+    for (int tree = 0; tree < numTreesToCheck; ++tree) {
+        const int32_t begin = roots[tree];
+        const int32_t end = tree + 1 < numTreesToCheck ? roots[tree + 1] : numNodesToCheck;
+
+        if ((tree == 0 && begin != 0) || begin < 0 || begin >= end || end > numNodesToCheck)
+            return false;
+
+        for (int32_t i = begin; i < end; ++i) {
+            const Node& node = treeNodes[i];
+            const QuantizedNode& q = treeQuantizedNodes[i];
+
+            if (node.feature < -1 || node.feature >= N_FEATURES || q.feature != node.feature)
+                return false;
+
+            if (node.feature >= 0
+                && (i + 1 >= end || node.rightChild <= i || node.rightChild >= end
+                    || q.rightChild <= 0 || node.rightChild != i + q.rightChild))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+bool RandomForestModel::writeBinary(juce::OutputStream& output) const
+{
+    if (numTrees == 0)
+        return false;
+
+    // The format always carries both node arrays
+    if (!quantizedAvailable) {
+        std::cerr << "Binary forest model not written: a tree is too large for 16-bit child offsets" << std::endl;
+        return false;
+    }
+
+    const size_t featureBytes = N_FEATURES * sizeof(float);
+
+    BinaryHeader header{};
+    header.magic = BINARY_MAGIC;
+    header.version = BINARY_VERSION;
+    header.headerBytes = alignSection(sizeof(BinaryHeader));
+    header.numFeatures = N_FEATURES;
+    header.numTrees = static_cast<uint32_t>(numTrees);
+    header.numNodes = static_cast<uint32_t>(numNodes);
+    header.totalPathLength = static_cast<uint32_t>(totalPathLength);
+    header.decisionThreshold = decisionThreshold;
+
+    header.scalerMeansOffset = header.headerBytes;
+    header.scalerStdsOffset = alignSection(header.scalerMeansOffset + featureBytes);
+    header.importanceOffset = alignSection(header.scalerStdsOffset + featureBytes);
+    header.treeRootsOffset = alignSection(header.importanceOffset + featureBytes);
+    header.nodesOffset = alignSection(header.treeRootsOffset + numTrees * sizeof(int32_t));
+    header.quantizedNodesOffset = alignSection(header.nodesOffset + getFloatModelBytes());
+    header.fileBytes = static_cast<uint32_t>(header.quantizedNodesOffset + getQuantizedModelBytes());
+
+    // Assemble the whole image so the checksum can go in the header
+    juce::MemoryBlock image(header.fileBytes, true);
+    auto* data = static_cast<char*>(image.getData());
+
+    std::copy_n(scalerMeans.data(), N_FEATURES, reinterpret_cast<float*>(data + header.scalerMeansOffset));
+    std::copy_n(scalerStds.data(), N_FEATURES, reinterpret_cast<float*>(data + header.scalerStdsOffset));
+    std::copy_n(featureImportance.data(), N_FEATURES, reinterpret_cast<float*>(data + header.importanceOffset));
+    std::copy_n(treeRoots, numTrees, reinterpret_cast<int32_t*>(data + header.treeRootsOffset));
+    std::copy_n(nodes, numNodes, reinterpret_cast<Node*>(data + header.nodesOffset));
+    std::copy_n(quantizedNodes, numNodes, reinterpret_cast<QuantizedNode*>(data + header.quantizedNodesOffset));
+
+    header.payloadChecksum = calculateChecksum(data + header.headerBytes, header.fileBytes - header.headerBytes);
+    std::memcpy(data, &header, sizeof(header));
+
+    return output.write(data, image.getSize());
+}
+
+uint32_t RandomForestModel::calculateChecksum(const void* data, size_t numBytes)
+{
+    // 32-bit FNV-1a
+    uint32_t hash = 2166136261u;
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < numBytes; ++i) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+bool RandomForestModel::appendTree(const juce::var& tree)
+{
+    auto* feature = tree["feature"].getArray();
+    auto* threshold = tree["threshold"].getArray();
+    auto* left = tree["children_left"].getArray();
+    auto* right = tree["children_right"].getArray();
+    auto* value = tree["value"].getArray();
+
+    if (feature == nullptr || threshold == nullptr || left == nullptr || right == nullptr || value == nullptr)
+        return false;
+
+    const int numNodes = feature->size();
+    if (numNodes == 0 || threshold->size() != numNodes || left->size() != numNodes
+        || right->size() != numNodes || value->size() != numNodes)
+        return false;
+
+    const int root = static_cast<int>(nodeStorage.size());
+    std::vector<int> depth(static_cast<size_t>(numNodes), 0);
+    int maxDepth = 0;
+
+    for (int i = 0; i < numNodes; ++i) {
+        Node node;
+        const int featureIndex = static_cast<int>((*feature)[i]);
+        const int leftChild = static_cast<int>((*left)[i]);
+        const int rightChild = static_cast<int>((*right)[i]);
+
+        if (leftChild < 0) {
+            // Leaf: sklearn stores per-class fractions as [[p_non_footstep, p_footstep]]
+            const juce::var& classes = (*value)[i][0];
+            float negative = static_cast<float>(classes[0]);
+            float positive = static_cast<float>(classes[1]);
+            node.feature = -1;
+            node.threshold = 0.0f;
+            node.rightChild = -1;
+            node.value = positive / std::max(positive + negative, 1e-9f);
+        } else {
+            // Pre-order layout is required so the left child is implicit
+            if (leftChild != i + 1 || rightChild <= i || rightChild >= numNodes
+                || featureIndex < 0 || featureIndex >= N_FEATURES)
+                return false;
+
+            node.feature = featureIndex;
+            node.threshold = static_cast<float>((*threshold)[i]);
+            node.rightChild = root + rightChild;
+            node.value = 0.0f;
+
+            depth[leftChild] = depth[rightChild] = depth[i] + 1;
+            maxDepth = std::max(maxDepth, depth[i] + 1);
+        }
+
+        nodeStorage.push_back(node);
+    }
+
+    treeRootStorage.push_back(root);
+    totalPathLength += maxDepth;
+    return true;
+}
+
+int16_t RandomForestModel::quantizeThreshold(float threshold)
+{
+    // floor() on both sides keeps "x <= t" monotone: any feature that went left
+    // in float still goes left; only values within 1/Q_ONE sigma above t can flip
+    float scaled = std::floor(threshold * Q_ONE);
+    return static_cast<int16_t>(juce::jlimit(-32767.0f, 32767.0f, scaled));
+}
+
+bool RandomForestModel::buildQuantizedNodes()
+{
+    quantizedNodeStorage.resize(nodeStorage.size());
+
+    for (size_t i = 0; i < nodeStorage.size(); ++i) {
+        const Node& node = nodeStorage[i];
+        QuantizedNode& q = quantizedNodeStorage[i];
+        const int32_t offset = node.feature >= 0 ? node.rightChild - static_cast<int32_t>(i) : -1;
+
+        // Unpruned trees can hold more than 32767 nodes below a split
+        if (offset > INT16_MAX) {
+            quantizedNodeStorage.clear();
+            return false;
+        }
+
+        q.feature = static_cast<int16_t>(node.feature);
+        q.threshold = node.feature >= 0 ? quantizeThreshold(node.threshold) : 0;
+        q.rightChild = static_cast<int16_t>(offset);
+        q.value = static_cast<uint16_t>(std::lround(juce::jlimit(0.0f, 1.0f, node.value) * 65535.0f));
+    }
+
+    return true;
+}
+
+float RandomForestModel::predict(const float* rawFeatures) const
+{
+    if (numTrees == 0)
+        return 0.0f;
+
+    FeatureVector scaled;
+    for (int i = 0; i < N_FEATURES; ++i)
+        scaled[i] = (rawFeatures[i] - scalerMeans[i]) / scalerStds[i];
+
+    float sum = 0.0f;
+    for (int tree = 0; tree < numTrees; ++tree) {
+        const Node* node = &nodes[treeRoots[tree]];
+        while (node->feature >= 0) {
+            node = scaled[node->feature] <= node->threshold ? node + 1 : &nodes[node->rightChild];
+        }
+        sum += node->value;
+    }
+
+    return sum / numTrees;
+}
+
+void RandomForestModel::quantizeFeatures(const float* rawFeatures, int16_t* quantizedFeatures) const
+{
+    for (int i = 0; i < N_FEATURES; ++i) {
+        float scaled = std::floor((rawFeatures[i] - scalerMeans[i]) * quantizationScales[i]);
+        quantizedFeatures[i] = static_cast<int16_t>(juce::jlimit(-32767.0f, 32767.0f, scaled));
+    }
+}
+
+float RandomForestModel::predictQuantized(const int16_t* quantizedFeatures) const
+{
+    if (numTrees == 0 || !quantizedAvailable)
+        return 0.0f;
+
+    uint32_t sum = 0;
+    for (int tree = 0; tree < numTrees; ++tree) {
+        const QuantizedNode* node = &quantizedNodes[treeRoots[tree]];
+        while (node->feature >= 0) {
+            node += quantizedFeatures[node->feature] <= node->threshold ? 1 : node->rightChild;
+        }
+        sum += node->value;
+    }
+
+    return static_cast<float>(sum) / (65535.0f * numTrees);
+}
+
+float RandomForestModel::predictProbability(const float* rawFeatures) const
+{
+    if (!isQuantizedMode())
+        return predict(rawFeatures);
+
+    QuantizedFeatureVector quantized;
+    quantizeFeatures(rawFeatures, quantized.data());
+    return predictQuantized(quantized.data());
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include "FootstepModel.h"
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <memory>
+
+// Random Forest exported by the training notebook (footstep_model_cpp.json).
+// Trees are flattened into one pre-order node array: the left child of a split
+// is always the next node, so only the right child index is stored.
+//
+// Two inference modes share the same trees:
+//  - float:     standardized float features vs float thresholds (16-byte nodes)
+//  - quantized: int16 features vs int16 thresholds (8-byte nodes, half the memory)
+//
+// The JSON export can be converted once (tools/ForestModelConverter) into a
+// binary file that is memory-mapped and used in place: both node arrays,
+// the tree roots and the scaler tables are stored exactly as inference reads them.
+class RandomForestModel : public FootstepModel
+{
+public:
+    // Quantized features are standardized values in units of 1/Q_ONE sigma,
+    // so int16 covers +/-8 sigma. Exported thresholds stay within +/-3.6 sigma.
+    static constexpr int Q_ONE = 4096;
+
+    struct Node
+    {
+        float threshold;
+        float value;        // P(footstep) for leaves
+        int32_t feature;    // -1 for leaves
+        int32_t rightChild;
+    };
+
+    struct QuantizedNode
+    {
+        int16_t threshold;
+        uint16_t value;     // P(footstep) * 65535 for leaves
+        int16_t feature;    // -1 for leaves
+        int16_t rightChild; // offset from this node; trees whose offsets do not fit have no quantized nodes
+    };
+
+    // Binary model file (.fsm), little-endian. Sections start on
+    // SECTION_ALIGNMENT boundaries and are addressed by byte offset from the
+    // start of the file; the checksum covers everything after the header.
+    //
+    //   header | scaler means | scaler stds | importance | tree roots | nodes | quantized nodes
+    static constexpr uint32_t BINARY_MAGIC = 0x424d5346;  // "FSMB"
+    static constexpr uint32_t BINARY_VERSION = 1;
+    static constexpr uint32_t SECTION_ALIGNMENT = 64;
+
+    struct BinaryHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t headerBytes;
+        uint32_t fileBytes;
+        uint32_t numFeatures;
+        uint32_t numTrees;
+        uint32_t numNodes;
+        uint32_t totalPathLength;
+        uint32_t scalerMeansOffset;
+        uint32_t scalerStdsOffset;
+        uint32_t importanceOffset;
+        uint32_t treeRootsOffset;
+        uint32_t nodesOffset;
+        uint32_t quantizedNodesOffset;
+        uint32_t payloadChecksum;   // FNV-1a over bytes [headerBytes, fileBytes)
+        float decisionThreshold;
+    };
+
+    using FeatureVector = std::array<float, N_FEATURES>;
+    using QuantizedFeatureVector = std::array<int16_t, N_FEATURES>;
+
+    RandomForestModel();
+    ~RandomForestModel() override;
+
+    bool loadFromFile(const juce::File& jsonFile);
+    bool loadFromJSON(const juce::String& jsonText);
+    bool isLoaded() const { return numTrees > 0; }
+
+    // Binary format: maps the file and points inference at it, nothing is copied
+    // except the 78-entry scaler tables. The mapping lives as long as the model.
+    bool loadFromBinaryFile(const juce::File& binaryFile, bool verifyChecksum = true);
+
+    // Same format from memory that outlives the model (e.g. compiled-in BinaryData)
+    bool loadFromBinaryData(const void* data, size_t size, bool verifyChecksum = true);
+    bool writeBinary(juce::OutputStream& output) const;
+    bool isMemoryMapped() const { return mappedFile != nullptr; }
+
+    static uint32_t calculateChecksum(const void* data, size_t numBytes);
+
+    // Inference on raw (unscaled) MFCC statistics from MFCCExtractor
+    float predict(const float* rawFeatures) const;
+    void quantizeFeatures(const float* rawFeatures, int16_t* quantizedFeatures) const;
+    float predictQuantized(const int16_t* quantizedFeatures) const;
+
+    // Dispatches to the float or quantized path. The quantized path is only taken
+    // when every right-child offset fits an int16 (see hasQuantizedNodes).
+    void setQuantizedMode(bool shouldUseQuantized) { useQuantized = shouldUseQuantized; }
+    bool isQuantizedMode() const { return useQuantized && quantizedAvailable; }
+    bool hasQuantizedNodes() const { return quantizedAvailable; }
+    float predictProbability(const float* rawFeatures) const override;
+
+    Tier getTier() const override { return Tier::FullForest; }
+    int getOperationsPerInference() const override { return totalPathLength; }
+    size_t getModelBytes() const override { return isQuantizedMode() ? getQuantizedModelBytes() : getFloatModelBytes(); }
+
+    int getNumTrees() const { return numTrees; }
+    int getNumNodes() const { return numNodes; }
+    size_t getFloatModelBytes() const { return static_cast<size_t>(numNodes) * sizeof(Node); }
+    size_t getQuantizedModelBytes() const { return static_cast<size_t>(numNodes) * sizeof(QuantizedNode); }
+
+    const FeatureVector& getScalerMeans() const { return scalerMeans; }
+    const FeatureVector& getScalerStds() const { return scalerStds; }
+    const FeatureVector& getFeatureImportance() const { return featureImportance; }
+
+private:
+    // Owned storage for JSON models; empty when a binary file is mapped
+    std::vector<Node> nodeStorage;
+    std::vector<QuantizedNode> quantizedNodeStorage;
+    std::vector<int32_t> treeRootStorage;
+    std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+    juce::HeapBlock<char> imageCopy;    // only for misaligned binary data
+
+    // What inference reads, pointing into either of the above
+    const Node* nodes = nullptr;
+    const QuantizedNode* quantizedNodes = nullptr;
+    const int32_t* treeRoots = nullptr;
+    int numTrees = 0;
+    int numNodes = 0;
+
+    FeatureVector scalerMeans{};
+    FeatureVector scalerStds{};
+    FeatureVector featureImportance{};
+
+    // Per-feature scale fusing standardization and int16 mapping: Q_ONE / std
+    FeatureVector quantizationScales{};
+
+    bool useQuantized = false;
+    bool quantizedAvailable = false;
+    int totalPathLength = 0;    // sum of tree depths, worst-case compares per inference
+
+    void clear();
+    void setScaler(const float* means, const float* stds);
+    void useOwnedStorage();
+    bool useBinaryImage(const char* data, size_t size, bool verifyChecksum, const juce::String& description);
+    static bool treesAreValid(const Node* treeNodes, const QuantizedNode* treeQuantizedNodes,
+                              const int32_t* roots, int numTreesToCheck, int numNodesToCheck);
+    bool appendTree(const juce::var& tree);
+    bool buildQuantizedNodes();
+    static int16_t quantizeThreshold(float threshold);
+};
@@ -0,0 +1,41 @@
+#include "RuleFootstepModel.h"
+#include <algorithm>
+
+RuleFootstepModel::RuleFootstepModel(Tier modelTier)
+    : tier(modelTier)
+{
+    scalerStds.fill(1.0f);
+}
+
+void RuleFootstepModel::setScaler(const std::array<float, N_FEATURES>& means, const std::array<float, N_FEATURES>& stds)
+{
+    scalerMeans = means;
+    for (int i = 0; i < N_FEATURES; ++i)
+        scalerStds[i] = std::max(stds[i], 1e-6f);
+}
+
+void RuleFootstepModel::addRule(const Rule& rule)
+{
+    if (rule.feature < 0 || rule.feature >= N_FEATURES || rule.weight <= 0.0f)
+        return;
+
+    rules.push_back(rule);
+    totalWeight += rule.weight;
+}
+
+float RuleFootstepModel::predictProbability(const float* rawFeatures) const
+{
+    if (rules.empty() || totalWeight <= 0.0f)
+        return 0.0f;
+
+    // Weighted vote: a firing rule contributes its footstep probability,
+    // a silent one the complement
+    float score = 0.0f;
+    for (const auto& rule : rules) {
+        float scaled = (rawFeatures[rule.feature] - scalerMeans[rule.feature]) / scalerStds[rule.feature];
+        bool fires = rule.greaterThan ? scaled > rule.threshold : scaled <= rule.threshold;
+        score += rule.weight * (fires ? rule.probability : 1.0f - rule.probability);
+    }
+
+    return juce::jlimit(0.0f, 1.0f, score / totalWeight);
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "FootstepModel.h"
+#include <vector>
+#include <array>
+
+// Weighted threshold rules (decision stumps) on standardized features.
+// Used for the cheap tiers: the simplified decision rules and the top-N
+// important features exported next to the full forests.
+class RuleFootstepModel : public FootstepModel
+{
+public:
+    struct Rule
+    {
+        int feature = 0;
+        float threshold = 0.0f;     // standardized units
+        float weight = 1.0f;
+        bool greaterThan = true;
+        float probability = 1.0f;   // P(footstep) when the rule fires
+    };
+
+    explicit RuleFootstepModel(Tier modelTier);
+
+    void setScaler(const std::array<float, N_FEATURES>& means, const std::array<float, N_FEATURES>& stds);
+    void addRule(const Rule& rule);
+    int getNumRules() const { return static_cast<int>(rules.size()); }
+
+    float predictProbability(const float* rawFeatures) const override;
+    Tier getTier() const override { return tier; }
+    int getOperationsPerInference() const override { return static_cast<int>(rules.size()); }
+    size_t getModelBytes() const override { return rules.size() * sizeof(Rule) + 2 * sizeof(scalerMeans); }
+
+private:
+    Tier tier;
+    std::vector<Rule> rules;
+    float totalWeight = 0.0f;
+
+    std::array<float, N_FEATURES> scalerMeans{};
+    std::array<float, N_FEATURES> scalerStds{};
+};
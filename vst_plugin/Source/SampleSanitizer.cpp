@@ -0,0 +1,59 @@
+#include "SampleSanitizer.h"
+#include <juce_dsp/juce_dsp.h>
+#include <cstdint>
+#include <cstring>
+
+namespace
+{
+    constexpr uint32_t exponentBits = 0x7f800000u;
+
+    bool isNonFinite(float sample)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &sample, sizeof(bits));
+        return (bits & exponentBits) == exponentBits;
+    }
+}
+
+bool SampleSanitizer::hasNonFinite(const float* samples, int numSamples)
+{
+    using Bits = juce::dsp::SIMDRegister<uint32_t>;
+    const int lanes = static_cast<int>(Bits::size());
+
+    // Unaligned head, aligned vector body, scalar tail
+    const auto* bits = reinterpret_cast<const uint32_t*>(samples);
+    const int head = juce::jmin(numSamples, static_cast<int>(Bits::getNextSIMDAlignedPtr(const_cast<uint32_t*>(bits)) - bits));
+
+    bool found = false;
+    for (int i = 0; i < head; ++i)
+        found |= isNonFinite(samples[i]);
+
+    const auto exponent = Bits::expand(exponentBits);
+    auto mask = Bits::expand(0u);
+    int i = head;
+
+    for (; i + lanes <= numSamples; i += lanes) {
+        const auto v = Bits::fromRawArray(bits + i);
+        mask = mask | Bits::equal(v & exponent, exponent);
+    }
+
+    for (; i < numSamples; ++i)
+        found |= isNonFinite(samples[i]);
+
+    return found || !(mask == Bits::expand(0u));
+}
+
+int SampleSanitizer::replaceNonFinite(float* samples, int numSamples)
+{
+    if (!hasNonFinite(samples, numSamples))
+        return 0;
+
+    int replaced = 0;
+    for (int i = 0; i < numSamples; ++i) {
+        if (isNonFinite(samples[i])) {
+            samples[i] = 0.0f;
+            ++replaced;
+        }
+    }
+    return replaced;
+}
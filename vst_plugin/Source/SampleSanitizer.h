@@ -0,0 +1,22 @@
+#pragma once
+
+// Clears denormal values out of filter state between blocks. juce::ScopedNoDenormals
+// sets flush-to-zero on x86 and arm64, so this only matters where the host or
+// target does not honour it; build with FOOTSTEP_FLUSH_DENORMALS=0 to leave it out.
+#ifndef FOOTSTEP_FLUSH_DENORMALS
+ #define FOOTSTEP_FLUSH_DENORMALS 1
+#endif
+
+// Guards the block path against non-finite input. A NaN or Inf from the host
+// would otherwise latch into the EQ and detector state for good.
+namespace SampleSanitizer
+{
+    // True if any sample is NaN or +-Inf. One branch-free vector pass: the
+    // exponent bits of every lane are compared against all-ones and the
+    // masks OR-ed together, so clean blocks cost a single scan.
+    bool hasNonFinite(const float* samples, int numSamples);
+
+    // Zeroes NaN and +-Inf samples in place and returns how many there were.
+    // Clean blocks are only scanned, never written.
+    int replaceNonFinite(float* samples, int numSamples);
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <iterator>
+#include <map>
+#include <memory>
+
+// Process-wide cache of immutable objects shared by every plugin instance in a
+// host (model weights, DSP tables). Objects are reference counted through the
+// returned shared_ptr; the cache only keeps weak references, so an object is
+// freed as soon as the last instance using it releases it.
+//
+// getOrCreate() builds missing objects under the cache lock, so instances
+// created at the same time wait for one build instead of duplicating it, and
+// drops the keys of objects that have been freed. Never call it from the audio
+// thread.
+template <typename ObjectType>
+class SharedObjectCache
+{
+public:
+    using Ptr = std::shared_ptr<const ObjectType>;
+
+    static SharedObjectCache& getInstance()
+    {
+        static SharedObjectCache instance;
+        return instance;
+    }
+
+    template <typename Factory>
+    Ptr getOrCreate(const juce::String& key, Factory&& createObject)
+    {
+        const juce::ScopedLock sl(lock);
+
+        // Keys are per model hash and sample rate: without this the map keeps
+        // growing as models are reloaded and hosts change rates
+        for (auto it = objects.begin(); it != objects.end();)
+            it = it->second.expired() && it->first != key ? objects.erase(it) : std::next(it);
+
+        auto& slot = objects[key];
+        if (auto existing = slot.lock())
+            return existing;
+
+        Ptr created = createObject();
+        slot = created;
+        return created;
+    }
+
+    int getNumLiveObjects() const
+    {
+        const juce::ScopedLock sl(lock);
+
+        int live = 0;
+        for (const auto& object : objects)
+            if (!object.second.expired())
+                live++;
+        return live;
+    }
+
+private:
+    SharedObjectCache() = default;
+
+    juce::CriticalSection lock;
+    std::map<juce::String, std::weak_ptr<const ObjectType>> objects;
+
+    JUCE_DECLARE_NON_COPYABLE(SharedObjectCache)
+};
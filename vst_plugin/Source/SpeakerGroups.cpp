@@ -0,0 +1,90 @@
+#include "SpeakerGroups.h"
+
+namespace
+{
+    enum GroupIndex { front = 0, surround, height, none };
+
+    GroupIndex getGroup(juce::AudioChannelSet::ChannelType type)
+    {
+        using Set = juce::AudioChannelSet;
+
+        switch (type)
+        {
+            case Set::LFE:
+            case Set::LFE2:
+                return none;
+
+            case Set::leftSurround:     case Set::rightSurround:
+            case Set::centreSurround:
+            case Set::leftSurroundSide: case Set::rightSurroundSide:
+            case Set::leftSurroundRear: case Set::rightSurroundRear:
+                return surround;
+
+            case Set::topMiddle:
+            case Set::topFrontLeft:     case Set::topFrontCentre:   case Set::topFrontRight:
+            case Set::topRearLeft:      case Set::topRearCentre:    case Set::topRearRight:
+            case Set::topSideLeft:      case Set::topSideRight:
+                return height;
+
+            default:
+                return front;
+        }
+    }
+}
+
+void SpeakerGroups::prepare(const juce::AudioChannelSet& layout)
+{
+    std::vector<Group> byIndex { { "Front", {} }, { "Surround", {} }, { "Height", {} } };
+    allChannels.clear();
+
+    const auto types = layout.getChannelTypes();
+    for (int channel = 0; channel < types.size(); ++channel) {
+        const auto group = getGroup(types.getUnchecked(channel));
+        if (group == none)
+            continue;
+
+        byIndex[static_cast<size_t>(group)].channels.push_back(channel);
+        allChannels.push_back(channel);
+    }
+
+    groups.clear();
+    for (auto& group : byIndex)
+        if (!group.channels.empty())
+            groups.push_back(std::move(group));
+
+    // Nothing but LFE: analyse it anyway rather than nothing
+    if (groups.empty()) {
+        for (int channel = 0; channel < juce::jmax(1, layout.size()); ++channel)
+            allChannels.push_back(channel);
+        groups.push_back({ "Front", allChannels });
+    }
+}
+
+int SpeakerGroups::getNumSignals(Mode mode) const
+{
+    return mode == perGroup ? getNumGroups() : 1;
+}
+
+const std::vector<int>& SpeakerGroups::getChannels(Mode mode, int signal) const
+{
+    jassert(!groups.empty());
+
+    switch (mode)
+    {
+        case perGroup:      return groups[static_cast<size_t>(juce::jlimit(0, getNumGroups() - 1, signal))].channels;
+        case frontSpeakers: return groups.front().channels;
+        case allSpeakers:
+        default:            return allChannels;
+    }
+}
+
+juce::String SpeakerGroups::getSignalName(Mode mode, int signal) const
+{
+    switch (mode)
+    {
+        case perGroup:      return groups[static_cast<size_t>(juce::jlimit(0, getNumGroups() - 1, signal))].name;
+        case frontSpeakers: return groups.front().name;
+        case allSpeakers:
+        default:            return "All";
+    }
+}
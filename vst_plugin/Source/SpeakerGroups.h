@@ -0,0 +1,42 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <vector>
+
+// SURROUND: which channels of the main bus feed the detector. LFE channels never
+// do (footsteps are not routed there, rumble is). Named layouts are split into
+// speaker groups - front (L, R, C, Lc, Rc, wides), surround (sides and rears) and
+// height (tops) - so a step behind the listener is not averaged away by the
+// front channels. Discrete (unnamed) channels count as front, so mono, stereo
+// and discrete layouts have one group and every mode gives the same downmix.
+class SpeakerGroups
+{
+public:
+    enum Mode
+    {
+        allSpeakers = 0,    // one downmix of every non-LFE channel
+        frontSpeakers,      // one downmix of the front group
+        perGroup            // one analysis signal, and detector, per group
+    };
+
+    static constexpr int maxGroups = 3;
+
+    void prepare(const juce::AudioChannelSet& layout);
+
+    int getNumGroups() const { return static_cast<int>(groups.size()); }
+
+    // Analysis signals for a mode: one, or one per non-empty group (front first)
+    int getNumSignals(Mode mode) const;
+    const std::vector<int>& getChannels(Mode mode, int signal) const;
+    juce::String getSignalName(Mode mode, int signal) const;
+
+private:
+    struct Group
+    {
+        juce::String name;
+        std::vector<int> channels;
+    };
+
+    std::vector<Group> groups;
+    std::vector<int> allChannels;
+};